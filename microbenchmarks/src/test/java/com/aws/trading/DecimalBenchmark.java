@@ -0,0 +1,108 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.Unpooled;
+import org.openjdk.jmh.annotations.*;
+import org.openjdk.jmh.infra.Blackhole;
+
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.concurrent.TimeUnit;
+
+@State(Scope.Thread)
+public class DecimalBenchmark {
+    static final int SCALE = 8;
+    static final long MULTIPLIER = 100_000_000L;
+    final double price = 27_123.45678912;
+    final long scaledPrice = 2_712_345_678_912L;
+    final ByteBuf sink = Unpooled.directBuffer(64);
+    final ByteBuf priceBytes = Unpooled.directBuffer(64).writeBytes("27123.45678912".getBytes(StandardCharsets.US_ASCII));
+    final AsciiView priceView = new AsciiView();
+    final String priceString = "27123.45678912";
+
+    // What StringMath.QtyToString did for every price: double to long to String to char[] to String, then to bytes
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_qty_to_string_write(Blackhole blackhole) {
+        sink.clear().writeBytes(qtyToString(price, SCALE, MULTIPLIER).getBytes(StandardCharsets.US_ASCII));
+        blackhole.consume(sink);
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_fixed_point_write(Blackhole blackhole) {
+        sink.clear();
+        AsciiNumbers.writeDecimal(sink, scaledPrice, SCALE);
+        blackhole.consume(sink);
+    }
+
+    // What StringMath.doubleToLong did: String.replace, then Long.parseLong
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public long benchmark_string_replace_parse() {
+        return Long.parseLong(priceString.replace(".", ""));
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public long benchmark_fixed_point_parse() {
+        priceView.wrap(priceBytes, priceBytes.readerIndex(), priceBytes.readableBytes());
+        return AsciiNumbers.parseDecimal(priceView, SCALE);
+    }
+
+    private static String qtyToString(double qty, int scale, long multiplier) {
+        final long scaled = Math.round(qty * multiplier);
+        final char[] digits = Long.toString(scaled).toCharArray();
+        final int length = digits.length;
+        final char[] out;
+        if (length > scale) {
+            out = new char[length + 1];
+            final int point = length - scale;
+            System.arraycopy(digits, 0, out, 0, point);
+            out[point] = '.';
+            System.arraycopy(digits, point, out, point + 1, length - point);
+        } else {
+            out = new char[scale + 2];
+            out[0] = '0';
+            out[1] = '.';
+            final int zeros = scale - length;
+            Arrays.fill(out, 2, zeros + 2, '0');
+            System.arraycopy(digits, 0, out, zeros + 2, length);
+        }
+        return new String(out);
+    }
+
+    public static void main(String[] args) {
+        try {
+            org.openjdk.jmh.Main.main(args);
+        } catch (IOException e) {
+            e.printStackTrace();
+        }
+    }
+}
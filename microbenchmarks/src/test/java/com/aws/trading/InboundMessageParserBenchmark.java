@@ -0,0 +1,70 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package com.aws.trading;
+
+import com.alibaba.fastjson2.JSON;
+import com.alibaba.fastjson2.JSONObject;
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.Unpooled;
+import org.openjdk.jmh.annotations.*;
+import org.openjdk.jmh.infra.Blackhole;
+
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.concurrent.TimeUnit;
+
+@State(Scope.Thread)
+public class InboundMessageParserBenchmark {
+    final static String bookedMessage = "{\"amount\":\"1\",\"channel_name\":\"TRADING\",\"client_id\":\"0c3a0a4e-7d4b-4b2c-9a5e-2f1b6c8d9e10\",\"instrument_code\":\"BTC_USDT\",\"order_book_sequence\":-4719374838211413612,\"order_id\":\"5d0b8a1e-3a65-4c39-8f0e-7f3c4b2a1d90\",\"price\":\"1\",\"side\":\"BUY\",\"time\":1697040000000,\"type\":\"BOOKED\",\"uid\":\"3002\"}";
+    final ByteBuf directBuffer = Unpooled.directBuffer(512).writeBytes(bookedMessage.getBytes(StandardCharsets.UTF_8));
+    final InboundMessageParser parser = new InboundMessageParser();
+
+    // What the handler used to do: copy the direct buffer to the heap and build a whole JSONObject
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_fastjson_copy(Blackhole blackhole) {
+        final byte[] bytes = new byte[directBuffer.readableBytes()];
+        directBuffer.getBytes(directBuffer.readerIndex(), bytes);
+        JSONObject parsedObject = JSON.parseObject(bytes, 0, bytes.length, StandardCharsets.UTF_8);
+        blackhole.consume(parsedObject.getString("type"));
+        blackhole.consume(parsedObject.getString("client_id"));
+        blackhole.consume(parsedObject.getString("instrument_code"));
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_inbound_parser(Blackhole blackhole) {
+        parser.parse(directBuffer);
+        blackhole.consume(parser.messageType());
+        blackhole.consume(parser.clientId.length());
+        blackhole.consume(parser.instrumentCode.length());
+    }
+
+    public static void main(String[] args) {
+        try {
+            org.openjdk.jmh.Main.main(args);
+        } catch (IOException e) {
+            e.printStackTrace();
+        }
+    }
+}
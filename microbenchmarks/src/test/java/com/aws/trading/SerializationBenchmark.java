@@ -19,7 +19,11 @@
 package com.aws.trading;
 
 import io.netty.buffer.ByteBuf;
+import io.netty.buffer.PooledByteBufAllocator;
 import io.netty.buffer.Unpooled;
+import io.netty.handler.codec.http.websocketx.BinaryWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.WebSocketFrame;
 import io.netty.util.CharsetUtil;
 import net.openhft.chronicle.bytes.Bytes;
 import net.openhft.chronicle.wire.JSONWire;
@@ -29,12 +33,22 @@ import org.openjdk.jmh.infra.Blackhole;
 import java.io.IOException;
 import java.nio.ByteBuffer;
 import java.nio.charset.StandardCharsets;
+import java.util.List;
+import java.util.Map;
 import java.util.concurrent.TimeUnit;
 
 @State(Scope.Thread)
 public class SerializationBenchmark {
     final Bytes<ByteBuffer> bytes = Bytes.elasticHeapByteBuffer(143).unchecked(true);
     JSONWire json = new JSONWire(bytes, false);
+    final ExchangeProtocolImpl compositeProtocol = new ExchangeProtocolImpl();
+    final TemplateExchangeProtocol templateProtocol = new TemplateExchangeProtocol(PooledByteBufAllocator.DEFAULT, List.of("BTC_USDT"));
+    final TemplateExchangeProtocol scaledTemplateProtocol = new TemplateExchangeProtocol(PooledByteBufAllocator.DEFAULT, List.of("BTC_USDT"),
+            new DecimalScales(Map.of("BTC_USDT", 2), Map.of("BTC_USDT", 8)));
+    final BinaryExchangeProtocol binaryProtocol = new BinaryExchangeProtocol(PooledByteBufAllocator.DEFAULT, List.of("BTC_USDT"));
+    final ClientIdGenerator clientIds = new SequentialClientIdGenerator(3002);
+    // stands in for the socket send buffer, the composite is walked a second time when it is copied out
+    final ByteBuf sink = Unpooled.directBuffer(512);
 
 
     //FASTEST!!!
@@ -126,6 +140,63 @@ public class SerializationBenchmark {
         return bytebuf;
     }
 
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_composite_protocol_write(Blackhole blackhole) {
+        TextWebSocketFrame frame = compositeProtocol.createBuyOrder("BTC_USDT", "3002000000000001");
+        sink.clear().writeBytes(frame.content());
+        frame.release();
+        blackhole.consume(sink);
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_template_protocol_write(Blackhole blackhole) {
+        TextWebSocketFrame frame = templateProtocol.createBuyOrder("BTC_USDT", clientIds, clientIds.next());
+        sink.clear().writeBytes(frame.content());
+        frame.release();
+        blackhole.consume(sink);
+    }
+
+    // 27123.45 for 1.5 at the fixed-point scales of a real instrument
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_template_scaled_order_write(Blackhole blackhole) {
+        WebSocketFrame frame = scaledTemplateProtocol.createLimitOrder("BTC_USDT", Side.BUY, clientIds, clientIds.next(),
+                2_712_345L, 150_000_000L);
+        sink.clear().writeBytes(frame.content());
+        frame.release();
+        blackhole.consume(sink);
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_template_cancel_write(Blackhole blackhole) {
+        TextWebSocketFrame frame = templateProtocol.createCancelOrder("BTC_USDT", "3002000000000001");
+        sink.clear().writeBytes(frame.content());
+        frame.release();
+        blackhole.consume(sink);
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_binary_protocol_write(Blackhole blackhole) {
+        BinaryWebSocketFrame frame = binaryProtocol.createBuyOrder("BTC_USDT", clientIds, clientIds.next());
+        sink.clear().writeBytes(frame.content());
+        frame.release();
+        blackhole.consume(sink);
+    }
+
     public static void main(String[] args) {
         try {
             org.openjdk.jmh.Main.main(args);
@@ -0,0 +1,106 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.Unpooled;
+import io.netty.channel.embedded.EmbeddedChannel;
+import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.WebSocket13FrameDecoder;
+import io.netty.handler.codec.http.websocketx.WebSocket13FrameEncoder;
+import io.netty.util.ReferenceCountUtil;
+import org.openjdk.jmh.annotations.*;
+import org.openjdk.jmh.infra.Blackhole;
+
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.concurrent.TimeUnit;
+
+@State(Scope.Thread)
+public class WebSocketCodecBenchmark {
+    final static String bookedMessage = "{\"amount\":\"1\",\"channel_name\":\"TRADING\",\"client_id\":\"3002000000000001\",\"instrument_code\":\"BTC_USDT\",\"order_book_sequence\":-4719374838211413612,\"order_id\":\"5d0b8a1e-3a65-4c39-8f0e-7f3c4b2a1d90\",\"price\":\"1\",\"side\":\"BUY\",\"time\":1697040000000,\"type\":\"BOOKED\",\"uid\":\"3002\"}";
+    final static byte[] payloadBytes = bookedMessage.getBytes(StandardCharsets.UTF_8);
+    final ByteBuf payload = Unpooled.directBuffer(payloadBytes.length).writeBytes(payloadBytes);
+    // what the server sends: unmasked text frame with a 16 bit length
+    final ByteBuf serverFrame = Unpooled.directBuffer(payloadBytes.length + 4)
+            .writeByte(0x81).writeByte(126).writeShort(payloadBytes.length).writeBytes(payloadBytes);
+    final EmbeddedChannel nettyEncoder = new EmbeddedChannel(new WebSocket13FrameEncoder(true));
+    final EmbeddedChannel fastEncoder = new EmbeddedChannel(new FastWebSocketFrameEncoder());
+    final EmbeddedChannel nettyDecoder = new EmbeddedChannel(new WebSocket13FrameDecoder(false, false, 65536));
+    final EmbeddedChannel fastDecoder = new EmbeddedChannel(new FastWebSocketFrameDecoder(65536));
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_netty_encode(Blackhole blackhole) {
+        nettyEncoder.writeOutbound(new TextWebSocketFrame(payload.retainedDuplicate()));
+        drainOutbound(nettyEncoder, blackhole);
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_fast_encode(Blackhole blackhole) {
+        fastEncoder.writeOutbound(payload.retainedDuplicate());
+        drainOutbound(fastEncoder, blackhole);
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_netty_decode(Blackhole blackhole) {
+        nettyDecoder.writeInbound(serverFrame.retainedDuplicate());
+        drainInbound(nettyDecoder, blackhole);
+    }
+
+    @Benchmark
+    @Fork(value = 1, warmups = 1)
+    @BenchmarkMode(Mode.AverageTime)
+    @OutputTimeUnit(TimeUnit.NANOSECONDS)
+    public void benchmark_fast_decode(Blackhole blackhole) {
+        fastDecoder.writeInbound(serverFrame.retainedDuplicate());
+        drainInbound(fastDecoder, blackhole);
+    }
+
+    private static void drainOutbound(EmbeddedChannel channel, Blackhole blackhole) {
+        ByteBuf buf;
+        while ((buf = channel.readOutbound()) != null) {
+            blackhole.consume(buf.readableBytes());
+            buf.release();
+        }
+    }
+
+    private static void drainInbound(EmbeddedChannel channel, Blackhole blackhole) {
+        Object msg;
+        while ((msg = channel.readInbound()) != null) {
+            blackhole.consume(msg);
+            ReferenceCountUtil.release(msg);
+        }
+    }
+
+    public static void main(String[] args) {
+        try {
+            org.openjdk.jmh.Main.main(args);
+        } catch (IOException e) {
+            e.printStackTrace();
+        }
+    }
+}
@@ -0,0 +1,37 @@
+//! Core lists and pinning threads to cores, so the server's threads stay off the cores given to the client or to
+//! interrupts when both run on one box.
+
+use std::io;
+use std::mem;
+
+/// Parses a core list like `taskset` takes, e.g. `0-3,8,10-11`.
+pub fn parse_core_list(list: &str) -> io::Result<Vec<usize>> {
+    let invalid = || io::Error::new(io::ErrorKind::InvalidInput, format!("invalid core list '{}'", list));
+    let mut cores = Vec::new();
+    for range in list.split(',') {
+        let (first, last) = match range.split_once('-') {
+            Some((first, last)) => (first.trim(), last.trim()),
+            None => (range.trim(), range.trim()),
+        };
+        let first: usize = first.parse().map_err(|_| invalid())?;
+        let last: usize = last.parse().map_err(|_| invalid())?;
+        if first > last || last >= libc::CPU_SETSIZE as usize {
+            return Err(invalid());
+        }
+        cores.extend(first..=last);
+    }
+    Ok(cores)
+}
+
+/// Pins a thread to `core`, e.g. `libc::pthread_self()` or a spawned thread's `JoinHandleExt::as_pthread_t`.
+pub fn pin(thread: libc::pthread_t, core: usize) -> io::Result<()> {
+    let result = unsafe {
+        let mut set: libc::cpu_set_t = mem::zeroed();
+        libc::CPU_SET(core, &mut set);
+        libc::pthread_setaffinity_np(thread, mem::size_of::<libc::cpu_set_t>(), &set)
+    };
+    if result != 0 {
+        return Err(io::Error::from_raw_os_error(result));
+    }
+    Ok(())
+}
@@ -0,0 +1,752 @@
+//! Load driver for the mock server, to know what the mock itself sustains before trusting the Java client's numbers.
+//! It spreads WebSocket connections over one thread per core, each with its own epoll instance, and sends
+//! CREATE_ORDER at a fixed total rate, answering every BOOKED with a CANCEL_ORDER like the Java client does. Orders
+//! follow a fixed timeline and their round trips are measured from when they were due rather than when they went out,
+//! so a server that falls behind shows up as latency instead of as fewer orders.
+//!
+//! Given a list of rates it steps through them on the same connections, and reports the highest one the server kept
+//! up with.
+
+use std::collections::HashMap;
+use std::io::{self, Read, Write};
+use std::mem;
+use std::net::TcpStream;
+use std::os::fd::{AsRawFd, FromRawFd, OwnedFd};
+use std::sync::{mpsc, Arc, Barrier};
+use std::thread;
+use std::time::Duration;
+
+const USAGE: &str = "usage: load [--host 127.0.0.1] [--port 8888] [--connections 1000] [--threads <cores>] \
+[--rate <orders/s>[,<orders/s>...]] [--duration 10] [--warmup 2] [--instrument BTC_USDT] [--binary]";
+
+const OPCODE_TEXT: u8 = 0x1;
+const OPCODE_BINARY: u8 = 0x2;
+const OPCODE_CLOSE: u8 = 0x8;
+const EVENT_CAPACITY: usize = 1024;
+const READ_CHUNK: usize = 64 * 1024;
+const TIMER: u64 = u64::MAX;
+/// How long a step waits for the responses still in flight when it ends.
+const DRAIN_NANOS: u64 = 2_000_000_000;
+
+const BINARY_SCHEMA_ID: u16 = 1;
+const BINARY_VERSION: u16 = 1;
+const CREATE_ORDER_TEMPLATE: u16 = 1;
+const CANCEL_ORDER_TEMPLATE: u16 = 2;
+const BOOKED_TEMPLATE: u16 = 3;
+const DONE_TEMPLATE: u16 = 4;
+
+struct Options {
+    host: String,
+    port: u16,
+    connections: usize,
+    threads: usize,
+    /// Orders per second over all connections, one step each.
+    rates: Vec<u64>,
+    duration_nanos: u64,
+    warmup_nanos: u64,
+    instrument: String,
+    binary: bool,
+}
+
+fn main() {
+    let options = match parse_options() {
+        Ok(options) => options,
+        Err(message) => {
+            eprintln!("{}\n{}", message, USAGE);
+            std::process::exit(2);
+        }
+    };
+    if let Err(e) = run(options) {
+        eprintln!("load failed: {}", e);
+        std::process::exit(1);
+    }
+}
+
+/// The argument following `name` on the command line.
+fn arg_value<'a>(args: &'a [String], name: &str) -> Option<&'a str> {
+    let position = args.iter().position(|arg| arg == name)?;
+    args.get(position + 1).map(String::as_str)
+}
+
+fn parsed<T: std::str::FromStr>(args: &[String], name: &str, default: T) -> Result<T, String> {
+    match arg_value(args, name) {
+        Some(value) => value.parse().map_err(|_| format!("invalid {} '{}'", name, value)),
+        None => Ok(default),
+    }
+}
+
+fn parse_options() -> Result<Options, String> {
+    let args: Vec<String> = std::env::args().collect();
+    if args.iter().any(|arg| arg == "--help" || arg == "-h") {
+        return Err(String::new());
+    }
+    let rates = arg_value(&args, "--rate")
+        .unwrap_or("10000")
+        .split(',')
+        .map(|rate| rate.trim().parse::<u64>().ok().filter(|&rate| rate > 0))
+        .collect::<Option<Vec<u64>>>()
+        .ok_or("--rate takes positive orders per second")?;
+    let options = Options {
+        host: arg_value(&args, "--host").unwrap_or("127.0.0.1").to_string(),
+        port: parsed(&args, "--port", 8888)?,
+        connections: parsed(&args, "--connections", 1000)?,
+        threads: parsed(&args, "--threads", thread::available_parallelism().map_or(1, |n| n.get()))?,
+        rates,
+        duration_nanos: parsed(&args, "--duration", 10u64)? * 1_000_000_000,
+        warmup_nanos: parsed(&args, "--warmup", 2u64)? * 1_000_000_000,
+        instrument: arg_value(&args, "--instrument").unwrap_or("BTC_USDT").to_string(),
+        binary: args.iter().any(|arg| arg == "--binary"),
+    };
+    if options.connections == 0 || options.threads == 0 {
+        return Err("--connections and --threads must be positive".to_string());
+    }
+    Ok(options)
+}
+
+fn run(options: Options) -> io::Result<()> {
+    let options = Arc::new(options);
+    let threads = options.threads.min(options.connections);
+    println!(
+        "{} connections to {}:{} on {} threads, {} orders",
+        options.connections,
+        options.host,
+        options.port,
+        threads,
+        if options.binary { "binary" } else { "JSON" }
+    );
+    // connections are opened here, so a server that isn't there fails before any load starts
+    let mut drivers = Vec::with_capacity(threads);
+    for index in 0..threads {
+        drivers.push(Driver::new(&options, index, threads)?);
+    }
+    // one more for the main thread, which starts every step together with the others
+    let barrier = Arc::new(Barrier::new(threads + 1));
+    let (results, steps) = mpsc::channel();
+    for (index, mut driver) in drivers.into_iter().enumerate() {
+        let (options, barrier, results) = (options.clone(), barrier.clone(), results.clone());
+        thread::Builder::new()
+            .name(format!("load-{}", index))
+            .spawn(move || driver.run(&options, &barrier, &results))?;
+    }
+
+    println!(
+        "{:>10} {:>10} {:>10} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9} {:>6} {:>9}",
+        "target/s",
+        "sent/s",
+        "done/s",
+        "p50 us",
+        "p90 us",
+        "p99 us",
+        "p99.9 us",
+        "max us",
+        "cxl p50",
+        "cxl p99",
+        "lost",
+        "lag p99"
+    );
+    let mut sustained = None;
+    for &rate in &options.rates {
+        barrier.wait();
+        let mut step = Step::default();
+        for _ in 0..threads {
+            // a failed thread reports instead of its step, the others are left behind when the process exits
+            step.add(&steps.recv().expect("load threads report every step")?);
+        }
+        let seconds = options.duration_nanos as f64 / 1e9;
+        let done = step.done as f64 / seconds;
+        let us = |histogram: &Histogram, quantile: f64| histogram.percentile(quantile) as f64 / 1e3;
+        println!(
+            "{:>10} {:>10.0} {:>10.0} {:>9.1} {:>9.1} {:>9.1} {:>9.1} {:>9.1} {:>9.1} {:>9.1} {:>6} {:>9.1}",
+            rate,
+            step.sent as f64 / seconds,
+            done,
+            us(&step.round_trips, 0.5),
+            us(&step.round_trips, 0.9),
+            us(&step.round_trips, 0.99),
+            us(&step.round_trips, 0.999),
+            step.round_trips.max as f64 / 1e3,
+            us(&step.cancels, 0.5),
+            us(&step.cancels, 0.99),
+            step.lost,
+            us(&step.lag, 0.99)
+        );
+        let driver_behind = step.lag.percentile(0.99) > 1_000_000;
+        // kept up: nearly all of the target rate booked in time and everything answered in the end
+        if step.lost == 0 && done >= 0.99 * rate as f64 && !driver_behind {
+            sustained = Some(rate);
+        }
+        if driver_behind {
+            println!("the load driver itself fell behind, the numbers above are the driver's as much as the server's");
+        }
+    }
+    match sustained {
+        Some(rate) => println!("highest rate sustained: {} orders/s", rate),
+        None => println!("no rate was sustained"),
+    }
+    Ok(())
+}
+
+/// What one step measured. Round trips run from when an order was due to its BOOKED, cancels from when they were
+/// sent to their DONE.
+#[derive(Default)]
+struct Step {
+    sent: u64,
+    /// Orders booked before the step ended, what the server kept up with.
+    done: u64,
+    round_trips: Histogram,
+    cancels: Histogram,
+    /// Orders or cancels never answered.
+    lost: u64,
+    /// How late the driver sent orders compared to when they were due.
+    lag: Histogram,
+}
+
+impl Step {
+    fn add(&mut self, other: &Step) {
+        self.sent += other.sent;
+        self.done += other.done;
+        self.round_trips.add(&other.round_trips);
+        self.cancels.add(&other.cancels);
+        self.lost += other.lost;
+        self.lag.add(&other.lag);
+    }
+}
+
+/// Log-linear buckets, 64 per power of two, which keeps every value within 1.6% like an HdrHistogram with two
+/// significant digits.
+struct Histogram {
+    counts: Vec<u64>,
+    total: u64,
+    max: u64,
+}
+
+const SUB_BUCKET_BITS: u32 = 6;
+const HISTOGRAM_BUCKETS: usize = ((64 - SUB_BUCKET_BITS as usize) << SUB_BUCKET_BITS) + (2 << SUB_BUCKET_BITS);
+
+impl Default for Histogram {
+    fn default() -> Self {
+        Self {
+            counts: vec![0; HISTOGRAM_BUCKETS],
+            total: 0,
+            max: 0,
+        }
+    }
+}
+
+impl Histogram {
+    fn index(value: u64) -> usize {
+        let magnitude = 63 - (value | 1).leading_zeros();
+        if magnitude <= SUB_BUCKET_BITS {
+            value as usize
+        } else {
+            let shift = magnitude - SUB_BUCKET_BITS;
+            ((shift as usize) << SUB_BUCKET_BITS) + (value >> shift) as usize
+        }
+    }
+
+    /// Highest value of the bucket, as HdrHistogram reports percentiles.
+    fn highest_at(index: usize) -> u64 {
+        if index < 2 << SUB_BUCKET_BITS {
+            return index as u64;
+        }
+        let shift = (index >> SUB_BUCKET_BITS) - 1;
+        let mantissa = (index & ((1 << SUB_BUCKET_BITS) - 1)) as u64 + (1 << SUB_BUCKET_BITS);
+        ((mantissa + 1) << shift) - 1
+    }
+
+    fn record(&mut self, value: u64) {
+        self.counts[Self::index(value)] += 1;
+        self.total += 1;
+        self.max = self.max.max(value);
+    }
+
+    fn add(&mut self, other: &Histogram) {
+        for (count, other) in self.counts.iter_mut().zip(&other.counts) {
+            *count += other;
+        }
+        self.total += other.total;
+        self.max = self.max.max(other.max);
+    }
+
+    fn percentile(&self, quantile: f64) -> u64 {
+        let target = ((quantile * self.total as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        for (index, &count) in self.counts.iter().enumerate() {
+            seen += count;
+            if seen >= target {
+                return Self::highest_at(index).min(self.max);
+            }
+        }
+        0
+    }
+}
+
+/// Nanoseconds of CLOCK_MONOTONIC, the clock the timer runs on.
+fn now() -> u64 {
+    let mut now = libc::timespec { tv_sec: 0, tv_nsec: 0 };
+    unsafe {
+        libc::clock_gettime(libc::CLOCK_MONOTONIC, &mut now);
+    }
+    now.tv_sec as u64 * 1_000_000_000 + now.tv_nsec as u64
+}
+
+fn check(result: libc::c_int) -> io::Result<libc::c_int> {
+    if result < 0 {
+        Err(io::Error::last_os_error())
+    } else {
+        Ok(result)
+    }
+}
+
+struct Connection {
+    stream: TcpStream,
+    input: Vec<u8>,
+    filled: usize,
+    output: Vec<u8>,
+    written: usize,
+    waiting_for_writable: bool,
+    next_client_id: u64,
+    /// When each order in flight was due and each cancel in flight was sent, by client id.
+    orders: HashMap<u64, u64>,
+    cancels: HashMap<u64, u64>,
+}
+
+/// One thread's connections, sending on a shared timeline round robin over them.
+struct Driver {
+    epoll: OwnedFd,
+    timer: OwnedFd,
+    connections: Vec<Connection>,
+    next: usize,
+    payload: Vec<u8>,
+    binary: bool,
+    instrument: Vec<u8>,
+    step: Step,
+    /// Orders due before this aren't measured.
+    measure_from: u64,
+    measure_until: u64,
+}
+
+impl Driver {
+    /// Opens the thread's share of the connections and gets every one of them authenticated and subscribed.
+    fn new(options: &Options, index: usize, threads: usize) -> io::Result<Self> {
+        let epoll = unsafe { OwnedFd::from_raw_fd(check(libc::epoll_create1(libc::EPOLL_CLOEXEC))?) };
+        let timer = unsafe {
+            OwnedFd::from_raw_fd(check(libc::timerfd_create(
+                libc::CLOCK_MONOTONIC,
+                libc::TFD_NONBLOCK | libc::TFD_CLOEXEC,
+            ))?)
+        };
+        let mut driver = Self {
+            epoll,
+            timer,
+            connections: Vec::new(),
+            next: 0,
+            payload: Vec::with_capacity(256),
+            binary: options.binary,
+            instrument: options.instrument.as_bytes().to_vec(),
+            step: Step::default(),
+            measure_from: 0,
+            measure_until: 0,
+        };
+        driver.control(libc::EPOLL_CTL_ADD, driver.timer.as_raw_fd(), TIMER, libc::EPOLLIN as u32)?;
+        for token in (index..options.connections).step_by(threads) {
+            let stream = open(options, token)?;
+            driver.control(
+                libc::EPOLL_CTL_ADD,
+                stream.as_raw_fd(),
+                driver.connections.len() as u64,
+                libc::EPOLLIN as u32,
+            )?;
+            driver.connections.push(Connection {
+                stream,
+                input: vec![0; READ_CHUNK],
+                filled: 0,
+                output: Vec::with_capacity(READ_CHUNK),
+                written: 0,
+                waiting_for_writable: false,
+                next_client_id: 1,
+                orders: HashMap::new(),
+                cancels: HashMap::new(),
+            });
+        }
+        Ok(driver)
+    }
+
+    fn control(&self, op: libc::c_int, fd: i32, token: u64, interest: u32) -> io::Result<()> {
+        let mut event = libc::epoll_event { events: interest, u64: token };
+        check(unsafe { libc::epoll_ctl(self.epoll.as_raw_fd(), op, fd, &mut event) }).map(|_| ())
+    }
+
+    fn run(&mut self, options: &Options, barrier: &Barrier, results: &mpsc::Sender<io::Result<Step>>) {
+        for &rate in &options.rates {
+            barrier.wait();
+            let step = self.run_step(options, rate);
+            let failed = step.is_err();
+            if results.send(step).is_err() || failed {
+                return;
+            }
+        }
+        for connection in &mut self.connections {
+            // a close frame, best effort
+            let _ = connection.stream.write_all(&[0x80 | OPCODE_CLOSE, 0x80, 0, 0, 0, 0]);
+        }
+    }
+
+    /// Sends orders at `rate` for the warmup and the duration, then waits for the answers still in flight.
+    fn run_step(&mut self, options: &Options, rate: u64) -> io::Result<Step> {
+        let threads = options.threads.min(options.connections) as u64;
+        // this thread's share of the rate
+        let interval = (1_000_000_000 * threads / rate).max(1);
+        let start = now();
+        self.measure_from = start + options.warmup_nanos;
+        let end = self.measure_from + options.duration_nanos;
+        self.measure_until = end;
+        let mut due = start;
+        while due < end {
+            let now = now();
+            while due <= now && due < end {
+                self.send_order(due, now)?;
+                due += interval;
+            }
+            self.flush_all()?;
+            self.set_timer(due.min(end))?;
+            self.poll()?;
+        }
+        // answers to what's still in flight
+        let deadline = end + DRAIN_NANOS;
+        while now() < deadline && self.in_flight() > 0 {
+            self.set_timer(deadline)?;
+            self.poll()?;
+        }
+        self.step.lost = self.in_flight() as u64;
+        for connection in &mut self.connections {
+            connection.orders.clear();
+            connection.cancels.clear();
+        }
+        Ok(mem::take(&mut self.step))
+    }
+
+    fn in_flight(&self) -> usize {
+        self.connections.iter().map(|c| c.orders.len() + c.cancels.len()).sum()
+    }
+
+    fn set_timer(&self, deadline: u64) -> io::Result<()> {
+        let spec = libc::itimerspec {
+            it_interval: libc::timespec { tv_sec: 0, tv_nsec: 0 },
+            it_value: libc::timespec {
+                tv_sec: (deadline / 1_000_000_000) as libc::time_t,
+                tv_nsec: (deadline % 1_000_000_000) as libc::c_long,
+            },
+        };
+        check(unsafe {
+            libc::timerfd_settime(self.timer.as_raw_fd(), libc::TFD_TIMER_ABSTIME, &spec, std::ptr::null_mut())
+        })
+        .map(|_| ())
+    }
+
+    /// Waits for the timer or responses, and answers every BOOKED read with a cancel.
+    fn poll(&mut self) -> io::Result<()> {
+        let mut events = [libc::epoll_event { events: 0, u64: 0 }; EVENT_CAPACITY];
+        let count = unsafe {
+            libc::epoll_wait(self.epoll.as_raw_fd(), events.as_mut_ptr(), EVENT_CAPACITY as i32, -1)
+        };
+        if count < 0 {
+            let e = io::Error::last_os_error();
+            return if e.kind() == io::ErrorKind::Interrupted { Ok(()) } else { Err(e) };
+        }
+        for event in &events[..count as usize] {
+            let token = event.u64;
+            if token == TIMER {
+                let mut expirations = [0u8; 8];
+                unsafe { libc::read(self.timer.as_raw_fd(), expirations.as_mut_ptr() as *mut libc::c_void, 8) };
+                continue;
+            }
+            let index = token as usize;
+            if event.events & libc::EPOLLIN as u32 != 0 && !self.read(index)? {
+                return Err(io::Error::new(io::ErrorKind::UnexpectedEof, "server closed a connection"));
+            }
+            self.flush(index)?;
+        }
+        Ok(())
+    }
+
+    fn send_order(&mut self, due: u64, now: u64) -> io::Result<()> {
+        let index = self.next;
+        self.next = (self.next + 1) % self.connections.len();
+        let connection = &mut self.connections[index];
+        let client_id = connection.next_client_id;
+        connection.next_client_id += 1;
+        self.payload.clear();
+        if self.binary {
+            write_binary_header(&mut self.payload, CREATE_ORDER_TEMPLATE, 44);
+            self.payload.extend_from_slice(&client_id.to_le_bytes());
+            self.payload.extend_from_slice(&1i64.to_le_bytes());
+            self.payload.extend_from_slice(&1i64.to_le_bytes());
+            // buy, limit, good till cancelled, padding
+            self.payload.extend_from_slice(&[0, 0, 0, 0]);
+            write_instrument(&mut self.payload, &self.instrument);
+        } else {
+            write!(
+                self.payload,
+                "{{\"type\":\"CREATE_ORDER\",\"order\":{{\"instrument_code\":\"{}\",\"client_id\":\"{}\",\"side\":\"BUY\",\
+                 \"type\":\"LIMIT\",\"price\":\"1\",\"amount\":\"1\",\"time_in_force\":\"GOOD_TILL_CANCELLED\"}}}}",
+                String::from_utf8_lossy(&self.instrument),
+                client_id
+            )?;
+        }
+        let opcode = if self.binary { OPCODE_BINARY } else { OPCODE_TEXT };
+        write_frame(&mut connection.output, opcode, &self.payload);
+        connection.orders.insert(client_id, due);
+        if due >= self.measure_from {
+            self.step.sent += 1;
+            self.step.lag.record(now - due);
+        }
+        Ok(())
+    }
+
+    /// Reads what the socket has and handles every complete frame, returns false once the server has closed it.
+    fn read(&mut self, index: usize) -> io::Result<bool> {
+        let mut open = true;
+        loop {
+            let connection = &mut self.connections[index];
+            if connection.filled == connection.input.len() {
+                connection.input.resize(connection.input.len() * 2, 0);
+            }
+            match connection.stream.read(&mut connection.input[connection.filled..]) {
+                Ok(0) => {
+                    open = false;
+                    break;
+                }
+                Ok(n) => connection.filled += n,
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => break,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                Err(e) => return Err(e),
+            }
+        }
+        let received = now();
+        // taken out of the connection while its frames are handled, which write to the connection
+        let mut input = mem::take(&mut self.connections[index].input);
+        let filled = self.connections[index].filled;
+        let mut start = 0;
+        while let Some((header_length, length)) = frame_length(&input[start..filled]) {
+            let payload = &input[start + header_length..start + header_length + length];
+            self.on_response(index, payload, received)?;
+            start += header_length + length;
+        }
+        input.copy_within(start..filled, 0);
+        let connection = &mut self.connections[index];
+        connection.filled = filled - start;
+        connection.input = input;
+        Ok(open)
+    }
+
+    fn on_response(&mut self, index: usize, payload: &[u8], received: u64) -> io::Result<()> {
+        let Some((booked, client_id)) = parse_response(payload, self.binary) else {
+            return Ok(());
+        };
+        let measured = self.measure_from;
+        let connection = &mut self.connections[index];
+        if booked {
+            let Some(due) = connection.orders.remove(&client_id) else {
+                return Ok(());
+            };
+            if due >= measured {
+                self.step.round_trips.record(received - due);
+                if received < self.measure_until {
+                    self.step.done += 1;
+                }
+            }
+            self.payload.clear();
+            if self.binary {
+                write_binary_header(&mut self.payload, CANCEL_ORDER_TEMPLATE, 24);
+                self.payload.extend_from_slice(&client_id.to_le_bytes());
+                write_instrument(&mut self.payload, &self.instrument);
+            } else {
+                write!(
+                    self.payload,
+                    "{{\"type\":\"CANCEL_ORDER\",\"instrument_code\":\"{}\",\"client_id\":\"{}\"}}",
+                    String::from_utf8_lossy(&self.instrument),
+                    client_id
+                )?;
+            }
+            let opcode = if self.binary { OPCODE_BINARY } else { OPCODE_TEXT };
+            write_frame(&mut connection.output, opcode, &self.payload);
+            connection.cancels.insert(client_id, if due >= measured { now() } else { 0 });
+        } else if let Some(sent) = connection.cancels.remove(&client_id) {
+            if sent != 0 {
+                self.step.cancels.record(received.saturating_sub(sent));
+            }
+        } else {
+            // an order rejected instead of booked
+            connection.orders.remove(&client_id);
+        }
+        Ok(())
+    }
+
+    fn flush_all(&mut self) -> io::Result<()> {
+        for index in 0..self.connections.len() {
+            self.flush(index)?;
+        }
+        Ok(())
+    }
+
+    /// Writes what the socket takes and waits for it to become writable again if that isn't everything.
+    fn flush(&mut self, index: usize) -> io::Result<()> {
+        let connection = &mut self.connections[index];
+        while connection.written < connection.output.len() {
+            match connection.stream.write(&connection.output[connection.written..]) {
+                Ok(n) => connection.written += n,
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => break,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                Err(e) => return Err(e),
+            }
+        }
+        let flushed = connection.written == connection.output.len();
+        if flushed {
+            connection.output.clear();
+            connection.written = 0;
+        }
+        if flushed == connection.waiting_for_writable {
+            connection.waiting_for_writable = !flushed;
+            let interest = if flushed { libc::EPOLLIN } else { libc::EPOLLIN | libc::EPOLLOUT } as u32;
+            let fd = connection.stream.as_raw_fd();
+            self.control(libc::EPOLL_CTL_MOD, fd, index as u64, interest)?;
+        }
+        Ok(())
+    }
+}
+
+/// Connects, upgrades to WebSocket, authenticates and subscribes with blocking calls, then leaves the socket
+/// non-blocking.
+fn open(options: &Options, token: usize) -> io::Result<TcpStream> {
+    let mut stream = TcpStream::connect((options.host.as_str(), options.port))?;
+    stream.set_nodelay(true)?;
+    stream.set_read_timeout(Some(Duration::from_secs(10)))?;
+    write!(
+        stream,
+        "GET / HTTP/1.1\r\nHost: {}:{}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\
+         Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n",
+        options.host, options.port
+    )?;
+    // nothing comes after the handshake response until the client sends something
+    let mut response = Vec::new();
+    let mut chunk = [0u8; 1024];
+    while find(&response, b"\r\n\r\n").is_none() {
+        let n = stream.read(&mut chunk)?;
+        if n == 0 {
+            return Err(io::Error::new(io::ErrorKind::UnexpectedEof, "closed during the WebSocket handshake"));
+        }
+        response.extend_from_slice(&chunk[..n]);
+    }
+    if !response.starts_with(b"HTTP/1.1 101") {
+        return Err(io::Error::new(io::ErrorKind::InvalidData, "WebSocket upgrade refused"));
+    }
+    let mut frame = Vec::new();
+    for (request, expected) in [
+        (format!("{{\"type\":\"AUTHENTICATE\",\"api_token\":\"{}\"}}", token), "AUTHENTICATED"),
+        ("{\"type\":\"SUBSCRIBE\",\"channels\":[{\"name\":\"TRADING\"}]}".to_string(), "SUBSCRIPTIONS"),
+    ] {
+        frame.clear();
+        write_frame(&mut frame, OPCODE_TEXT, request.as_bytes());
+        stream.write_all(&frame)?;
+        let reply = read_frame(&mut stream)?;
+        if find(&reply, expected.as_bytes()).is_none() {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                format!("expected {}, got {}", expected, String::from_utf8_lossy(&reply)),
+            ));
+        }
+    }
+    stream.set_nonblocking(true)?;
+    Ok(stream)
+}
+
+fn read_frame(stream: &mut TcpStream) -> io::Result<Vec<u8>> {
+    let mut header = [0u8; 2];
+    stream.read_exact(&mut header)?;
+    let length = match header[1] & 0x7F {
+        126 => {
+            let mut length = [0u8; 2];
+            stream.read_exact(&mut length)?;
+            u16::from_be_bytes(length) as usize
+        }
+        127 => {
+            let mut length = [0u8; 8];
+            stream.read_exact(&mut length)?;
+            u64::from_be_bytes(length) as usize
+        }
+        length => length as usize,
+    };
+    let mut payload = vec![0; length];
+    stream.read_exact(&mut payload)?;
+    Ok(payload)
+}
+
+/// Header and payload length of the unmasked server frame at the start of `buf`, `None` until it's all there.
+fn frame_length(buf: &[u8]) -> Option<(usize, usize)> {
+    let (header_length, length) = match *buf.get(1)? & 0x7F {
+        126 => (4, u16::from_be_bytes([*buf.get(2)?, *buf.get(3)?]) as usize),
+        127 => (10, u64::from_be_bytes(buf.get(2..10)?.try_into().ok()?) as usize),
+        length => (2, length as usize),
+    };
+    (buf.len() >= header_length + length).then_some((header_length, length))
+}
+
+/// Masked client frame. The mask is fixed, it only has to be there.
+fn write_frame(out: &mut Vec<u8>, opcode: u8, payload: &[u8]) {
+    const MASK: [u8; 4] = [0x37, 0xfa, 0x21, 0x3d];
+    out.push(0x80 | opcode);
+    if payload.len() < 126 {
+        out.push(0x80 | payload.len() as u8);
+    } else if payload.len() <= u16::MAX as usize {
+        out.push(0x80 | 126);
+        out.extend_from_slice(&(payload.len() as u16).to_be_bytes());
+    } else {
+        out.push(0x80 | 127);
+        out.extend_from_slice(&(payload.len() as u64).to_be_bytes());
+    }
+    out.extend_from_slice(&MASK);
+    out.extend(payload.iter().enumerate().map(|(i, byte)| byte ^ MASK[i & 3]));
+}
+
+fn write_binary_header(out: &mut Vec<u8>, template: u16, block_length: u16) {
+    for field in [block_length, template, BINARY_SCHEMA_ID, BINARY_VERSION] {
+        out.extend_from_slice(&field.to_le_bytes());
+    }
+}
+
+fn write_instrument(out: &mut Vec<u8>, instrument: &[u8]) {
+    let mut padded = [0u8; 16];
+    let length = instrument.len().min(padded.len());
+    padded[..length].copy_from_slice(&instrument[..length]);
+    out.extend_from_slice(&padded);
+}
+
+/// Whether the response is a BOOKED (or else a DONE) and its client id, `None` for anything else.
+fn parse_response(payload: &[u8], binary: bool) -> Option<(bool, u64)> {
+    if binary {
+        let template = u16::from_le_bytes(payload.get(2..4)?.try_into().ok()?);
+        let client_id = u64::from_le_bytes(payload.get(8..16)?.try_into().ok()?);
+        return match template {
+            BOOKED_TEMPLATE => Some((true, client_id)),
+            DONE_TEMPLATE => Some((false, client_id)),
+            _ => None,
+        };
+    }
+    let booked = if find(payload, b"\"type\":\"BOOKED\"").is_some() {
+        true
+    } else if find(payload, b"\"type\":\"DONE\"").is_some() {
+        false
+    } else {
+        return None;
+    };
+    let start = find(payload, b"\"client_id\":\"")? + b"\"client_id\":\"".len();
+    let digits = &payload[start..];
+    let end = digits.iter().position(|&b| b == b'"')?;
+    let client_id = std::str::from_utf8(&digits[..end]).ok()?.parse().ok()?;
+    Some((booked, client_id))
+}
+
+fn find(haystack: &[u8], needle: &[u8]) -> Option<usize> {
+    haystack.windows(needle.len()).position(|window| window == needle)
+}
@@ -0,0 +1,197 @@
+//! Fixed layout binary order entry, the server side of the client's `BinarySchema`.
+//!
+//! Every message is an 8 byte header (block length, template id, schema id, version, all u16) followed by a
+//! fixed block. Integers are little endian and instrument codes are ASCII padded with NUL bytes. Responses end with
+//! the server's monotonic receive and send times in nanoseconds.
+
+use crate::order_book::{OrderKind, Report, ReportKind, Side, Status};
+
+pub const SCHEMA_ID: u16 = 1;
+pub const VERSION: u16 = 1;
+pub const HEADER_LENGTH: usize = 8;
+pub const INSTRUMENT_LENGTH: usize = 16;
+
+pub const CREATE_ORDER_TEMPLATE: u16 = 1;
+pub const CANCEL_ORDER_TEMPLATE: u16 = 2;
+pub const BOOKED_TEMPLATE: u16 = 3;
+pub const DONE_TEMPLATE: u16 = 4;
+pub const FILL_TEMPLATE: u16 = 5;
+
+const CREATE_ORDER_BLOCK_LENGTH: usize = 44;
+const CANCEL_ORDER_BLOCK_LENGTH: usize = 24;
+const BOOKED_BLOCK_LENGTH: usize = 88;
+const DONE_BLOCK_LENGTH: usize = 72;
+const FILL_BLOCK_LENGTH: usize = 96;
+
+pub const SIDE_BUY: u8 = 0;
+pub const SIDE_SELL: u8 = 1;
+
+pub const ORDER_TYPE_MARKET: u8 = 1;
+pub const TIME_IN_FORCE_IMMEDIATE_OR_CANCELLED: u8 = 1;
+
+pub const STATUS_CANCELLED: u8 = 0;
+pub const STATUS_FILLED: u8 = 1;
+pub const STATUS_REJECTED: u8 = 2;
+
+pub struct CreateOrder {
+    pub client_order_id: [u8; 8],
+    pub price: i64,
+    pub amount: i64,
+    pub side: u8,
+    pub order_type: u8,
+    pub time_in_force: u8,
+    pub instrument: [u8; INSTRUMENT_LENGTH],
+}
+
+impl CreateOrder {
+    pub fn kind(&self) -> OrderKind {
+        if self.order_type == ORDER_TYPE_MARKET {
+            OrderKind::Market
+        } else if self.time_in_force == TIME_IN_FORCE_IMMEDIATE_OR_CANCELLED {
+            OrderKind::ImmediateOrCancel
+        } else {
+            OrderKind::Limit
+        }
+    }
+}
+
+pub struct CancelOrder {
+    pub client_order_id: [u8; 8],
+    pub instrument: [u8; INSTRUMENT_LENGTH],
+}
+
+pub enum Request {
+    CreateOrder(CreateOrder),
+    CancelOrder(CancelOrder),
+}
+
+fn u16_at(buf: &[u8], offset: usize) -> u16 {
+    u16::from_le_bytes([buf[offset], buf[offset + 1]])
+}
+
+fn i64_at(buf: &[u8], offset: usize) -> i64 {
+    let mut bytes = [0u8; 8];
+    bytes.copy_from_slice(&buf[offset..offset + 8]);
+    i64::from_le_bytes(bytes)
+}
+
+fn array_at<const N: usize>(buf: &[u8], offset: usize) -> [u8; N] {
+    let mut bytes = [0u8; N];
+    bytes.copy_from_slice(&buf[offset..offset + N]);
+    bytes
+}
+
+/// Decodes a CREATE_ORDER or CANCEL_ORDER, `None` if the bytes are anything else.
+pub fn decode(buf: &[u8]) -> Option<Request> {
+    if buf.len() < HEADER_LENGTH || u16_at(buf, 4) != SCHEMA_ID {
+        return None;
+    }
+    let block_length = u16_at(buf, 0) as usize;
+    if buf.len() < HEADER_LENGTH + block_length {
+        return None;
+    }
+    let block = &buf[HEADER_LENGTH..];
+    match u16_at(buf, 2) {
+        CREATE_ORDER_TEMPLATE if block_length >= CREATE_ORDER_BLOCK_LENGTH => {
+            Some(Request::CreateOrder(CreateOrder {
+                client_order_id: array_at(block, 0),
+                price: i64_at(block, 8),
+                amount: i64_at(block, 16),
+                side: block[24],
+                order_type: block[25],
+                time_in_force: block[26],
+                instrument: array_at(block, 28),
+            }))
+        }
+        CANCEL_ORDER_TEMPLATE if block_length >= CANCEL_ORDER_BLOCK_LENGTH => {
+            Some(Request::CancelOrder(CancelOrder {
+                client_order_id: array_at(block, 0),
+                instrument: array_at(block, 8),
+            }))
+        }
+        _ => None,
+    }
+}
+
+fn write_header(buf: &mut Vec<u8>, template_id: u16, block_length: usize) {
+    buf.reserve(HEADER_LENGTH + block_length);
+    buf.extend_from_slice(&(block_length as u16).to_le_bytes());
+    buf.extend_from_slice(&template_id.to_le_bytes());
+    buf.extend_from_slice(&SCHEMA_ID.to_le_bytes());
+    buf.extend_from_slice(&VERSION.to_le_bytes());
+}
+
+/// Times of the request's receipt and the response's send, see `clock`.
+pub struct ServerTimes {
+    pub recv_ns: u64,
+    pub send_ns: u64,
+}
+
+pub fn encode_report(report: &Report, time: u64, times: ServerTimes) -> Vec<u8> {
+    let mut buf = Vec::new();
+    write_report(&mut buf, report, time, times);
+    buf
+}
+
+/// Appends the BOOKED, FILL or DONE of the report to `buf`.
+pub fn write_report(buf: &mut Vec<u8>, report: &Report, time: u64, times: ServerTimes) {
+    let side = match report.side {
+        Side::Buy => SIDE_BUY,
+        Side::Sell => SIDE_SELL,
+    };
+    match report.kind {
+        ReportKind::Booked => {
+            write_header(buf, BOOKED_TEMPLATE, BOOKED_BLOCK_LENGTH);
+            write_ids(buf, report);
+            buf.extend_from_slice(&report.price.to_le_bytes());
+            buf.extend_from_slice(&report.amount.to_le_bytes());
+            buf.extend_from_slice(&time.to_le_bytes());
+            buf.push(side);
+            buf.extend_from_slice(&[0u8; 7]);
+        }
+        ReportKind::Fill => {
+            write_header(buf, FILL_TEMPLATE, FILL_BLOCK_LENGTH);
+            write_ids(buf, report);
+            buf.extend_from_slice(&report.price.to_le_bytes());
+            buf.extend_from_slice(&report.amount.to_le_bytes());
+            buf.extend_from_slice(&report.remaining.to_le_bytes());
+            buf.extend_from_slice(&time.to_le_bytes());
+            buf.push(side);
+            buf.extend_from_slice(&[0u8; 7]);
+        }
+        ReportKind::Done(status) => {
+            write_header(buf, DONE_TEMPLATE, DONE_BLOCK_LENGTH);
+            write_ids(buf, report);
+            buf.extend_from_slice(&time.to_le_bytes());
+            buf.push(match status {
+                Status::Cancelled => STATUS_CANCELLED,
+                Status::Filled => STATUS_FILLED,
+                Status::Rejected => STATUS_REJECTED,
+            });
+            buf.extend_from_slice(&[0u8; 7]);
+        }
+    }
+    let mut instrument = [0u8; INSTRUMENT_LENGTH];
+    let code = report.instrument.as_bytes();
+    instrument[..code.len()].copy_from_slice(code);
+    buf.extend_from_slice(&instrument);
+    buf.extend_from_slice(&times.recv_ns.to_le_bytes());
+    buf.extend_from_slice(&times.send_ns.to_le_bytes());
+}
+
+/// Overwrites the send time of a report `write_report` wrote, which it ends with.
+pub fn stamp_send_ns(report: &mut [u8], send_ns: u64) {
+    let end = report.len();
+    report[end - 8..].copy_from_slice(&send_ns.to_le_bytes());
+}
+
+/// Client order id, order id and order book sequence, which every response starts with.
+fn write_ids(buf: &mut Vec<u8>, report: &Report) {
+    let mut client_order_id = [0u8; 8];
+    let id = report.client_id.as_bytes();
+    let length = id.len().min(8);
+    client_order_id[..length].copy_from_slice(&id[..length]);
+    buf.extend_from_slice(&client_order_id);
+    buf.extend_from_slice(&report.order_id.to_le_bytes());
+    buf.extend_from_slice(&(report.sequence as i64).to_le_bytes());
+}
@@ -0,0 +1,12 @@
+/// Nanoseconds of CLOCK_MONOTONIC, the clock `recv_ns` and `send_ns` in responses are taken from. Only differences
+/// between two readings on this host mean anything.
+pub fn monotonic_nanos() -> u64 {
+    let mut now = libc::timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    unsafe {
+        libc::clock_gettime(libc::CLOCK_MONOTONIC, &mut now);
+    }
+    now.tv_sec as u64 * 1_000_000_000 + now.tv_nsec as u64
+}
@@ -0,0 +1,298 @@
+//! Synthetic matching engine latency: how long a response is held back after its request was read. A profile is
+//! given on the command line as `--delay <profile>`:
+//!
+//! - `fixed:<d>` always `d`
+//! - `uniform:<min>,<max>` evenly spread between `min` and `max`
+//! - `lognormal:<median>,<sigma>` log-normal around `median`, `sigma` being the standard deviation of its logarithm
+//! - `bimodal:<base>,<pause>,<probability>` `base`, but `pause` for the given fraction of messages, like a venue
+//!   stalling in a GC pause
+//! - `replay:<file>` sampled from the round trips of a histogram file the client wrote, as `latency_report.sh` reads
+//!
+//! Durations take a `ns`, `us`, `ms` or `s` suffix. Responses of one connection leave in the order their requests
+//! came in, so a message sampled behind a pause holds back the ones after it, as a stalled engine would.
+
+use std::fs;
+use std::io::{self, Read};
+
+use base64::engine::general_purpose::STANDARD;
+use base64::Engine;
+use flate2::read::ZlibDecoder;
+
+pub enum DelayProfile {
+    Fixed(u64),
+    Uniform { min: u64, max: u64 },
+    LogNormal { mu: f64, sigma: f64 },
+    Bimodal { base: u64, pause: u64, probability: f64 },
+    /// Values in nanoseconds and their cumulative counts, both ascending.
+    Replay { values: Vec<u64>, cumulative: Vec<u64> },
+}
+
+impl DelayProfile {
+    pub fn parse(spec: &str) -> io::Result<Self> {
+        let (kind, args) = spec.split_once(':').unwrap_or((spec, ""));
+        let args: Vec<&str> = args.split(',').map(str::trim).collect();
+        let arity = |n: usize| {
+            if args.len() == n {
+                Ok(())
+            } else {
+                Err(invalid(format!("delay profile '{}' takes {} arguments", kind, n)))
+            }
+        };
+        match kind {
+            "fixed" => {
+                arity(1)?;
+                Ok(Self::Fixed(parse_duration(args[0])?))
+            }
+            "uniform" => {
+                arity(2)?;
+                let (min, max) = (parse_duration(args[0])?, parse_duration(args[1])?);
+                if min > max {
+                    return Err(invalid(format!("uniform delay has min {} over max {}", args[0], args[1])));
+                }
+                Ok(Self::Uniform { min, max })
+            }
+            "lognormal" => {
+                arity(2)?;
+                let median = parse_duration(args[0])?.max(1);
+                Ok(Self::LogNormal {
+                    mu: (median as f64).ln(),
+                    sigma: parse_fraction(args[1], f64::MAX)?,
+                })
+            }
+            "bimodal" => {
+                arity(3)?;
+                Ok(Self::Bimodal {
+                    base: parse_duration(args[0])?,
+                    pause: parse_duration(args[1])?,
+                    probability: parse_fraction(args[2], 1.0)?,
+                })
+            }
+            "replay" => {
+                arity(1)?;
+                read_histogram_log(args[0])
+            }
+            _ => Err(invalid(format!("unknown delay profile '{}'", spec))),
+        }
+    }
+
+    /// Draws the delay of one response in nanoseconds.
+    pub fn sample(&self, rng: &mut Rng) -> u64 {
+        match self {
+            Self::Fixed(delay) => *delay,
+            Self::Uniform { min, max } => min + rng.next_u64() % (max - min + 1),
+            Self::LogNormal { mu, sigma } => {
+                // Box-Muller, 1 - u keeps the logarithm finite
+                let (u1, u2) = (1.0 - rng.next_f64(), rng.next_f64());
+                let z = (-2.0 * u1.ln()).sqrt() * (2.0 * std::f64::consts::PI * u2).cos();
+                (mu + sigma * z).exp() as u64
+            }
+            Self::Bimodal { base, pause, probability } => {
+                if rng.next_f64() < *probability {
+                    *pause
+                } else {
+                    *base
+                }
+            }
+            Self::Replay { values, cumulative } => {
+                let target = rng.next_u64() % cumulative[cumulative.len() - 1];
+                values[cumulative.partition_point(|&count| count <= target)]
+            }
+        }
+    }
+}
+
+/// SplitMix64: enough randomness for delays at a few nanoseconds per draw, without locking or thread locals.
+pub struct Rng(u64);
+
+impl Rng {
+    pub fn new(seed: u64) -> Self {
+        Self(seed)
+    }
+
+    pub fn next_u64(&mut self) -> u64 {
+        self.0 = self.0.wrapping_add(0x9E37_79B9_7F4A_7C15);
+        let mut z = self.0;
+        z = (z ^ (z >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+        z ^ (z >> 31)
+    }
+
+    /// Uniform in [0, 1).
+    pub fn next_f64(&mut self) -> f64 {
+        (self.next_u64() >> 11) as f64 / (1u64 << 53) as f64
+    }
+}
+
+fn invalid(message: String) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidInput, message)
+}
+
+fn parse_duration(text: &str) -> io::Result<u64> {
+    let split = text.find(|c: char| !c.is_ascii_digit()).unwrap_or(text.len());
+    let (number, unit) = text.split_at(split);
+    let scale = match unit {
+        "ns" => 1,
+        "us" => 1_000,
+        "ms" => 1_000_000,
+        "s" => 1_000_000_000,
+        _ => return Err(invalid(format!("duration '{}' needs a ns, us, ms or s suffix", text))),
+    };
+    number
+        .parse::<u64>()
+        .map(|n| n * scale)
+        .map_err(|_| invalid(format!("invalid duration '{}'", text)))
+}
+
+fn parse_fraction(text: &str, max: f64) -> io::Result<f64> {
+    match text.parse::<f64>() {
+        Ok(value) if (0.0..=max).contains(&value) => Ok(value),
+        _ => Err(invalid(format!("invalid number '{}', expected 0 to {}", text, max))),
+    }
+}
+
+const V2_ENCODING_COOKIE: i32 = 0x1c84_9303;
+const V2_COMPRESSED_ENCODING_COOKIE: i32 = 0x1c84_9304;
+/// Cookies carry the word size in these bits.
+const COOKIE_WORD_SIZE_BITS: i32 = 0xf0;
+const ENCODING_HEADER_LENGTH: usize = 40;
+
+/// Merges the untagged intervals of a histogram log, the round trips, into one distribution. Tagged intervals are
+/// latency stages and are skipped, as `LatencyReport` does.
+fn read_histogram_log(path: &str) -> io::Result<DelayProfile> {
+    let log = fs::read_to_string(path)?;
+    let mut counts: Vec<u64> = Vec::new();
+    let mut layout = None;
+    for line in log.lines() {
+        if line.is_empty() || line.starts_with('#') || line.starts_with('"') || line.starts_with("Tag=") {
+            continue;
+        }
+        let Some(encoded) = line.rsplit(',').next() else {
+            continue;
+        };
+        let bytes = STANDARD
+            .decode(encoded.trim())
+            .map_err(|e| invalid(format!("invalid histogram in {}: {}", path, e)))?;
+        let interval = decode_compressed(&bytes).ok_or_else(|| invalid(format!("invalid histogram in {}", path)))?;
+        if counts.len() < interval.counts.len() {
+            counts.resize(interval.counts.len(), 0);
+        }
+        for (total, count) in counts.iter_mut().zip(&interval.counts) {
+            *total += count;
+        }
+        layout = Some(interval.layout);
+    }
+    let layout = layout.ok_or_else(|| invalid(format!("no round trip histograms in {}", path)))?;
+    let mut values = Vec::new();
+    let mut cumulative = Vec::new();
+    let mut total = 0;
+    for (index, &count) in counts.iter().enumerate() {
+        if count > 0 {
+            total += count;
+            values.push(layout.value_from_index(index));
+            cumulative.push(total);
+        }
+    }
+    if total == 0 {
+        return Err(invalid(format!("round trip histograms in {} are empty", path)));
+    }
+    info!("Replaying {} round trips from {}", total, path);
+    Ok(DelayProfile::Replay { values, cumulative })
+}
+
+/// Bucket layout of an HdrHistogram, which maps a counts index to the lowest value it counts.
+#[derive(Clone, Copy)]
+struct Layout {
+    unit_magnitude: u32,
+    sub_bucket_half_count_magnitude: u32,
+}
+
+impl Layout {
+    fn new(lowest_discernible_value: u64, significant_digits: u32) -> Self {
+        let largest_value_with_single_unit_resolution = 2 * 10u64.pow(significant_digits);
+        let sub_bucket_count_magnitude = 64 - (largest_value_with_single_unit_resolution - 1).leading_zeros();
+        Self {
+            unit_magnitude: 63 - lowest_discernible_value.max(1).leading_zeros(),
+            sub_bucket_half_count_magnitude: sub_bucket_count_magnitude.max(1) - 1,
+        }
+    }
+
+    fn value_from_index(&self, index: usize) -> u64 {
+        let sub_bucket_half_count = 1usize << self.sub_bucket_half_count_magnitude;
+        let mut bucket_index = (index >> self.sub_bucket_half_count_magnitude) as i64 - 1;
+        let mut sub_bucket_index = (index & (sub_bucket_half_count - 1)) + sub_bucket_half_count;
+        if bucket_index < 0 {
+            sub_bucket_index -= sub_bucket_half_count;
+            bucket_index = 0;
+        }
+        (sub_bucket_index as u64) << (bucket_index as u32 + self.unit_magnitude)
+    }
+}
+
+struct Interval {
+    layout: Layout,
+    counts: Vec<u64>,
+}
+
+fn read_i32(bytes: &[u8], at: usize) -> Option<i32> {
+    Some(i32::from_be_bytes(bytes.get(at..at + 4)?.try_into().ok()?))
+}
+
+fn read_i64(bytes: &[u8], at: usize) -> Option<i64> {
+    Some(i64::from_be_bytes(bytes.get(at..at + 8)?.try_into().ok()?))
+}
+
+/// HdrHistogram's V2 compressed encoding: a cookie and a length, then the zlib deflated V2 encoding.
+fn decode_compressed(bytes: &[u8]) -> Option<Interval> {
+    if read_i32(bytes, 0)? & !COOKIE_WORD_SIZE_BITS != V2_COMPRESSED_ENCODING_COOKIE {
+        return None;
+    }
+    let length = read_i32(bytes, 4)? as usize;
+    let mut encoded = Vec::new();
+    ZlibDecoder::new(bytes.get(8..8 + length)?)
+        .read_to_end(&mut encoded)
+        .ok()?;
+    decode(&encoded)
+}
+
+/// HdrHistogram's V2 encoding: a 40 byte header, then the counts as ZigZag LEB128 numbers where a negative number
+/// stands for that many empty buckets.
+fn decode(bytes: &[u8]) -> Option<Interval> {
+    if read_i32(bytes, 0)? & !COOKIE_WORD_SIZE_BITS != V2_ENCODING_COOKIE {
+        return None;
+    }
+    let payload_length = read_i32(bytes, 4)? as usize;
+    let significant_digits = read_i32(bytes, 12)? as u32;
+    let lowest_discernible_value = read_i64(bytes, 16)? as u64;
+    let mut payload = bytes.get(ENCODING_HEADER_LENGTH..ENCODING_HEADER_LENGTH + payload_length)?;
+    let mut counts = Vec::new();
+    while !payload.is_empty() {
+        let count = read_zig_zag(&mut payload)?;
+        if count < 0 {
+            counts.resize(counts.len() + (-count) as usize, 0);
+        } else {
+            counts.push(count as u64);
+        }
+    }
+    Some(Interval {
+        layout: Layout::new(lowest_discernible_value, significant_digits),
+        counts,
+    })
+}
+
+/// LEB128 with at most 9 bytes, the last one contributing all of its 8 bits, then ZigZag decoded.
+fn read_zig_zag(bytes: &mut &[u8]) -> Option<i64> {
+    let mut value = 0u64;
+    for i in 0..9 {
+        let (&byte, rest) = bytes.split_first()?;
+        *bytes = rest;
+        if i == 8 {
+            value |= (byte as u64) << 56;
+            break;
+        }
+        value |= ((byte & 0x7f) as u64) << (7 * i);
+        if byte & 0x80 == 0 {
+            break;
+        }
+    }
+    Some((value >> 1) as i64 ^ -((value & 1) as i64))
+}
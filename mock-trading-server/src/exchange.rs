@@ -0,0 +1,95 @@
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, MutexGuard};
+
+use crate::order_book::{Books, NewOrder, Report};
+use crate::order_entry::{self, Response};
+
+/// Hands a response for an order of one session to its connection, with when the request that caused it was read.
+pub type Sink = Arc<dyn Fn(Response, u64) + Send + Sync>;
+
+struct Member {
+    user_id: Option<String>,
+    sink: Option<Sink>,
+}
+
+/// The order books every connection of the actix server and the TCP listener trades against. A request's own
+/// responses are returned to its session, responses for the resting orders of other sessions go to their sinks.
+pub struct Exchange {
+    books: Mutex<Books<u64>>,
+    members: Mutex<HashMap<u64, Member>>,
+    next_owner: AtomicU64,
+}
+
+impl Exchange {
+    pub fn new() -> Self {
+        Self {
+            books: Mutex::new(Books::new()),
+            members: Mutex::new(HashMap::new()),
+            next_owner: AtomicU64::new(1),
+        }
+    }
+
+    /// Owner id of a new session.
+    pub fn join(&self) -> u64 {
+        let owner = self.next_owner.fetch_add(1, Ordering::Relaxed);
+        self.members.lock().unwrap().insert(owner, Member { user_id: None, sink: None });
+        owner
+    }
+
+    pub fn set_user_id(&self, owner: u64, user_id: &str) {
+        if let Some(member) = self.members.lock().unwrap().get_mut(&owner) {
+            member.user_id = Some(user_id.to_string());
+        }
+    }
+
+    pub fn set_sink(&self, owner: u64, sink: Sink) {
+        if let Some(member) = self.members.lock().unwrap().get_mut(&owner) {
+            member.sink = Some(sink);
+        }
+    }
+
+    /// Takes the session and its resting orders out of the exchange.
+    pub fn leave(&self, owner: u64) {
+        let mut books = self.books.lock().unwrap();
+        books.cancel_all(owner);
+        self.members.lock().unwrap().remove(&owner);
+    }
+
+    pub fn submit(&self, instrument: &[u8], order: &NewOrder<u64>, recv_ns: u64, own: &mut Vec<Report>) {
+        let mut others = Vec::new();
+        let mut books = self.books.lock().unwrap();
+        books.submit(instrument, order, |owner, binary, report| {
+            if owner == order.owner {
+                own.push(*report);
+            } else {
+                others.push((owner, binary, *report));
+            }
+        });
+        self.deliver(books, others, recv_ns);
+    }
+
+    pub fn cancel(&self, instrument: &[u8], owner: u64, binary: bool, client_id: &[u8], own: &mut Vec<Report>) {
+        // a cancel only ever reports to the session that sent it
+        self.books
+            .lock()
+            .unwrap()
+            .cancel(instrument, owner, binary, client_id, |_, _, report| own.push(*report));
+    }
+
+    /// Hands the reports to their sessions. The members are locked before the books are let go, so the reports of
+    /// one session reach it in the order the books made them.
+    fn deliver(&self, books: MutexGuard<Books<u64>>, reports: Vec<(u64, bool, Report)>, recv_ns: u64) {
+        if reports.is_empty() {
+            return;
+        }
+        let members = self.members.lock().unwrap();
+        drop(books);
+        for (owner, binary, report) in reports {
+            let Some(Member { user_id, sink: Some(sink) }) = members.get(&owner) else {
+                continue;
+            };
+            sink(order_entry::format_report(&report, binary, user_id.as_deref(), recv_ns), recv_ns);
+        }
+    }
+}
@@ -0,0 +1,132 @@
+//! Just enough HTTP/1.1 for the benchmark client: the balances POST and the WebSocket upgrade.
+
+use base64::engine::general_purpose::STANDARD;
+use base64::Engine;
+
+const WEBSOCKET_GUID: &[u8] = b"258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+pub enum Request<'a> {
+    /// `GET` with a `Sec-WebSocket-Key`.
+    Upgrade { key: &'a [u8] },
+    /// Any other request, answered with a 200.
+    Other { path: &'a [u8] },
+}
+
+/// Parses the request at the start of `buf`. Returns the request and the number of bytes it took, header and body,
+/// or `None` if it hasn't been read completely yet.
+pub fn parse(buf: &[u8]) -> Option<(Request<'_>, usize)> {
+    let header_end = find(buf, b"\r\n\r\n")? + 4;
+    let mut lines = buf[..header_end - 4].split(|&b| b == b'\n').map(trim);
+    let request_line = lines.next()?;
+    let mut parts = request_line.split(|&b| b == b' ');
+    let method = parts.next()?;
+    let path = parts.next().unwrap_or(b"/");
+    let mut key = None;
+    let mut content_length = 0;
+    for line in lines {
+        let Some(colon) = line.iter().position(|&b| b == b':') else {
+            continue;
+        };
+        let name = &line[..colon];
+        let value = trim(&line[colon + 1..]);
+        if name.eq_ignore_ascii_case(b"sec-websocket-key") {
+            key = Some(value);
+        } else if name.eq_ignore_ascii_case(b"content-length") {
+            content_length = std::str::from_utf8(value).ok()?.parse::<usize>().ok()?;
+        }
+    }
+    let length = header_end + content_length;
+    if buf.len() < length {
+        return None;
+    }
+    match key {
+        Some(key) if method == b"GET" => Some((Request::Upgrade { key }, length)),
+        _ => Some((Request::Other { path }, length)),
+    }
+}
+
+pub fn write_upgrade_response(out: &mut Vec<u8>, key: &[u8]) {
+    let mut accept = Vec::with_capacity(key.len() + WEBSOCKET_GUID.len());
+    accept.extend_from_slice(key);
+    accept.extend_from_slice(WEBSOCKET_GUID);
+    out.extend_from_slice(
+        b"HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ",
+    );
+    out.extend_from_slice(STANDARD.encode(sha1(&accept)).as_bytes());
+    out.extend_from_slice(b"\r\n\r\n");
+}
+
+pub fn write_ok_response(out: &mut Vec<u8>, body: &[u8]) {
+    out.extend_from_slice(b"HTTP/1.1 200 OK\r\ncontent-type: text/plain; charset=utf-8\r\ncontent-length: ");
+    out.extend_from_slice(body.len().to_string().as_bytes());
+    out.extend_from_slice(b"\r\n\r\n");
+    out.extend_from_slice(body);
+}
+
+fn find(haystack: &[u8], needle: &[u8]) -> Option<usize> {
+    haystack.windows(needle.len()).position(|window| window == needle)
+}
+
+fn trim(mut bytes: &[u8]) -> &[u8] {
+    while let [first, rest @ ..] = bytes {
+        if !first.is_ascii_whitespace() {
+            break;
+        }
+        bytes = rest;
+    }
+    while let [rest @ .., last] = bytes {
+        if !last.is_ascii_whitespace() {
+            break;
+        }
+        bytes = rest;
+    }
+    bytes
+}
+
+/// SHA-1 as RFC 6455 needs it for the accept key, not for anything that has to be secure.
+fn sha1(message: &[u8]) -> [u8; 20] {
+    let mut h: [u32; 5] = [0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0];
+    let mut padded = message.to_vec();
+    padded.push(0x80);
+    while padded.len() % 64 != 56 {
+        padded.push(0);
+    }
+    padded.extend_from_slice(&((message.len() as u64) * 8).to_be_bytes());
+    for chunk in padded.chunks(64) {
+        let mut w = [0u32; 80];
+        for i in 0..16 {
+            w[i] = u32::from_be_bytes([chunk[4 * i], chunk[4 * i + 1], chunk[4 * i + 2], chunk[4 * i + 3]]);
+        }
+        for i in 16..80 {
+            w[i] = (w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16]).rotate_left(1);
+        }
+        let [mut a, mut b, mut c, mut d, mut e] = h;
+        for (i, &word) in w.iter().enumerate() {
+            let (f, k) = match i {
+                0..=19 => ((b & c) | (!b & d), 0x5A827999),
+                20..=39 => (b ^ c ^ d, 0x6ED9EBA1),
+                40..=59 => ((b & c) | (b & d) | (c & d), 0x8F1BBCDC),
+                _ => (b ^ c ^ d, 0xCA62C1D6),
+            };
+            let temp = a
+                .rotate_left(5)
+                .wrapping_add(f)
+                .wrapping_add(e)
+                .wrapping_add(k)
+                .wrapping_add(word);
+            e = d;
+            d = c;
+            c = b.rotate_left(30);
+            b = a;
+            a = temp;
+        }
+        for (state, value) in h.iter_mut().zip([a, b, c, d, e]) {
+            *state = state.wrapping_add(value);
+        }
+    }
+    let mut digest = [0u8; 20];
+    for (i, state) in h.iter().enumerate() {
+        digest[4 * i..4 * i + 4].copy_from_slice(&state.to_be_bytes());
+    }
+    digest
+}
@@ -0,0 +1,354 @@
+//! Single pass, zero copy handling of the JSON order entry messages. Requests are scanned once for the handful of
+//! fields the responses need, which are kept as slices of the read buffer, and responses are built by copying a
+//! template rendered when the connection authenticated and patching its fixed width numbers in place.
+
+use crate::clock::monotonic_nanos;
+use crate::order_book::{Report, ReportKind, Side, Status};
+
+const MAX_CHANNELS: usize = 8;
+
+/// Fields of a request, each a slice of the request's bytes with string values still escaped.
+#[derive(Default)]
+pub struct Fields<'a> {
+    pub msg_type: &'a [u8],
+    pub api_token: &'a [u8],
+    pub client_id: &'a [u8],
+    pub instrument_code: &'a [u8],
+    pub side: &'a [u8],
+    pub order_type: &'a [u8],
+    pub time_in_force: &'a [u8],
+    pub price: &'a [u8],
+    pub amount: &'a [u8],
+    pub channels: [&'a [u8]; MAX_CHANNELS],
+    pub channel_count: usize,
+}
+
+impl<'a> Fields<'a> {
+    fn set(&mut self, depth: usize, key: &[u8], value: &'a [u8]) {
+        match key {
+            // orders have a type of their own one level down
+            b"type" if depth == 1 => self.msg_type = value,
+            b"type" => self.order_type = value,
+            b"time_in_force" => self.time_in_force = value,
+            b"api_token" => self.api_token = value,
+            b"client_id" => self.client_id = value,
+            b"instrument_code" => self.instrument_code = value,
+            b"side" => self.side = value,
+            b"price" => self.price = value,
+            b"amount" => self.amount = value,
+            b"name" if self.channel_count < MAX_CHANNELS => {
+                self.channels[self.channel_count] = value;
+                self.channel_count += 1;
+            }
+            _ => {}
+        }
+    }
+}
+
+/// End of the string starting after the opening quote at `start`, i.e. the index of its closing quote.
+fn string_end(buf: &[u8], start: usize) -> Option<usize> {
+    let mut i = start;
+    while i < buf.len() {
+        match buf[i] {
+            b'\\' => i += 2,
+            b'"' => return Some(i),
+            _ => i += 1,
+        }
+    }
+    None
+}
+
+fn skip_whitespace(buf: &[u8], mut i: usize) -> usize {
+    while i < buf.len() && buf[i].is_ascii_whitespace() {
+        i += 1;
+    }
+    i
+}
+
+/// Scans a JSON object once, collecting the fields `Fields` knows about. Returns `None` if the message isn't
+/// well-formed enough to be scanned.
+pub fn scan(buf: &[u8]) -> Option<Fields<'_>> {
+    let mut fields = Fields::default();
+    let mut depth = 0usize;
+    let mut i = 0;
+    while i < buf.len() {
+        match buf[i] {
+            b'{' | b'[' => depth += 1,
+            b'}' | b']' => depth = depth.checked_sub(1)?,
+            b'"' => {
+                let end = string_end(buf, i + 1)?;
+                let token = &buf[i + 1..end];
+                i = skip_whitespace(buf, end + 1);
+                if i >= buf.len() || buf[i] != b':' {
+                    // a string in an array, or the last value of an object
+                    continue;
+                }
+                i = skip_whitespace(buf, i + 1);
+                match buf.get(i) {
+                    Some(b'"') => {
+                        let value_end = string_end(buf, i + 1)?;
+                        fields.set(depth, token, &buf[i + 1..value_end]);
+                        i = value_end + 1;
+                    }
+                    // nested values are walked by the loop itself
+                    Some(b'{') | Some(b'[') => {}
+                    Some(_) => {
+                        let start = i;
+                        while i < buf.len() && !matches!(buf[i], b',' | b'}' | b']') && !buf[i].is_ascii_whitespace() {
+                            i += 1;
+                        }
+                        fields.set(depth, token, &buf[start..i]);
+                    }
+                    None => return None,
+                }
+                continue;
+            }
+            _ => {}
+        }
+        i += 1;
+    }
+    if depth != 0 {
+        return None;
+    }
+    Some(fields)
+}
+
+/// A rendered response prefix and the offsets of the fixed width fields to patch in every copy.
+struct Template {
+    bytes: Vec<u8>,
+    sequence: usize,
+    order_id: usize,
+    time: usize,
+    recv_ns: usize,
+    send_ns: usize,
+}
+
+const SEQUENCE_DIGITS: usize = 19;
+const ORDER_ID_HEX_DIGITS: usize = 12;
+const TIME_DIGITS: usize = 13;
+/// Wide enough for any u64; the numbers are right aligned after JSON whitespace.
+const NANOS_WIDTH: usize = 20;
+
+impl Template {
+    fn render(head: &str, uid: &[u8], order_id_prefix: &str) -> Self {
+        let mut bytes = head.as_bytes().to_vec();
+        bytes.extend_from_slice(b"\"order_book_sequence\":");
+        let sequence = bytes.len();
+        bytes.extend_from_slice(&[b'0'; SEQUENCE_DIGITS]);
+        bytes.extend_from_slice(b",\"uid\":\"");
+        bytes.extend_from_slice(uid);
+        bytes.extend_from_slice(b"\",\"order_id\":\"");
+        bytes.extend_from_slice(order_id_prefix.as_bytes());
+        let order_id = bytes.len();
+        bytes.extend_from_slice(&[b'0'; ORDER_ID_HEX_DIGITS]);
+        bytes.extend_from_slice(b"\",\"channel_name\":\"TRADING\",\"time\":");
+        let time = bytes.len();
+        bytes.extend_from_slice(&[b'0'; TIME_DIGITS]);
+        bytes.extend_from_slice(b",\"recv_ns\":");
+        let recv_ns = bytes.len();
+        bytes.extend_from_slice(&[b' '; NANOS_WIDTH]);
+        bytes.extend_from_slice(b",\"send_ns\":");
+        let send_ns = bytes.len();
+        bytes.extend_from_slice(&[b' '; NANOS_WIDTH]);
+        Self {
+            bytes,
+            sequence,
+            order_id,
+            time,
+            recv_ns,
+            send_ns,
+        }
+    }
+
+    /// The send time is read last, right before the copy is complete. Returns the offset of its slot.
+    fn write(&self, out: &mut Vec<u8>, sequence: u64, order_id: u64, time: u64, recv_ns: u64) -> usize {
+        let base = out.len();
+        out.extend_from_slice(&self.bytes);
+        write_decimal(&mut out[base + self.sequence..base + self.sequence + SEQUENCE_DIGITS], sequence);
+        write_hex(&mut out[base + self.order_id..base + self.order_id + ORDER_ID_HEX_DIGITS], order_id);
+        write_decimal(&mut out[base + self.time..base + self.time + TIME_DIGITS], time);
+        write_padded_decimal(&mut out[base + self.recv_ns..base + self.recv_ns + NANOS_WIDTH], recv_ns);
+        write_padded_decimal(&mut out[base + self.send_ns..base + self.send_ns + NANOS_WIDTH], monotonic_nanos());
+        self.send_ns
+    }
+}
+
+/// Overwrites the send time of a report whose slot starts at `slot`, for responses sent later than they were built.
+/// Times only grow, so the new digits cover the old ones.
+pub fn stamp_send_ns(slot: &mut [u8], send_ns: u64) {
+    write_padded_decimal(&mut slot[..NANOS_WIDTH], send_ns);
+}
+
+fn write_decimal(slot: &mut [u8], mut value: u64) {
+    for digit in slot.iter_mut().rev() {
+        *digit = b'0' + (value % 10) as u8;
+        value /= 10;
+    }
+}
+
+/// Right aligned in the slot, which keeps the spaces the template has on the left.
+fn write_padded_decimal(slot: &mut [u8], mut value: u64) {
+    for digit in slot.iter_mut().rev() {
+        *digit = b'0' + (value % 10) as u8;
+        value /= 10;
+        if value == 0 {
+            break;
+        }
+    }
+}
+
+/// Appends the digits of `value` without going through a String.
+fn push_integer(out: &mut Vec<u8>, value: i64) {
+    let mut digits = [0u8; 20];
+    let mut start = digits.len();
+    let mut rest = value.unsigned_abs();
+    loop {
+        start -= 1;
+        digits[start] = b'0' + (rest % 10) as u8;
+        rest /= 10;
+        if rest == 0 {
+            break;
+        }
+    }
+    if value < 0 {
+        out.push(b'-');
+    }
+    out.extend_from_slice(&digits[start..]);
+}
+
+/// Integer price or amount of an order, `None` for anything else.
+pub fn parse_integer(text: &[u8]) -> Option<i64> {
+    let (negative, digits) = match text.split_first() {
+        Some((b'-', digits)) => (true, digits),
+        _ => (false, text),
+    };
+    if digits.is_empty() {
+        return None;
+    }
+    let mut value: i64 = 0;
+    for &digit in digits {
+        if !digit.is_ascii_digit() {
+            return None;
+        }
+        value = value.checked_mul(10)?.checked_add((digit - b'0') as i64)?;
+    }
+    Some(if negative { -value } else { value })
+}
+
+fn write_hex(slot: &mut [u8], mut value: u64) {
+    const HEX: &[u8; 16] = b"0123456789abcdef";
+    for digit in slot.iter_mut().rev() {
+        *digit = HEX[(value & 15) as usize];
+        value >>= 4;
+    }
+}
+
+struct Templates {
+    booked: Template,
+    fill: Template,
+    done: Template,
+}
+
+/// Answers the JSON messages of one connection. Orders go to the order books, which report back through
+/// `write_report`.
+pub struct Responder {
+    shard: u32,
+    uid: Vec<u8>,
+    templates: Option<Templates>,
+}
+
+impl Responder {
+    /// `shard` goes into every order id so ids from different cores don't collide.
+    pub fn new(shard: u32) -> Self {
+        Self {
+            shard,
+            uid: Vec::new(),
+            templates: None,
+        }
+    }
+
+    pub fn is_authenticated(&self) -> bool {
+        self.templates.is_some()
+    }
+
+    /// Writes the response to a message other than an order into `out`, returns false if there is none. `time` is
+    /// milliseconds since the epoch, read once per batch of messages by the caller.
+    pub fn respond(&mut self, fields: &Fields, time: u64, out: &mut Vec<u8>) -> bool {
+        match fields.msg_type {
+            b"AUTHENTICATE" => {
+                self.uid = fields.api_token.to_vec();
+                let order_id_prefix = format!("{:08x}-0000-4000-8000-", self.shard);
+                self.templates = Some(Templates {
+                    booked: Template::render("{\"type\":\"BOOKED\",", &self.uid, &order_id_prefix),
+                    fill: Template::render("{\"type\":\"FILL\",", &self.uid, &order_id_prefix),
+                    done: Template::render("{\"type\":\"DONE\",", &self.uid, &order_id_prefix),
+                });
+                out.extend_from_slice(b"{\"type\":\"AUTHENTICATED\"}");
+                true
+            }
+            b"SUBSCRIBE" => {
+                out.extend_from_slice(b"{\"type\":\"SUBSCRIPTIONS\",\"channels\":[");
+                for (i, name) in fields.channels[..fields.channel_count].iter().enumerate() {
+                    if i > 0 {
+                        out.push(b',');
+                    }
+                    out.extend_from_slice(b"{\"account_id\":\"");
+                    out.extend_from_slice(&self.uid);
+                    out.extend_from_slice(b"\",\"name\":\"");
+                    out.extend_from_slice(name);
+                    out.extend_from_slice(b"\"}");
+                }
+                out.extend_from_slice(b"],\"time\":");
+                push_integer(out, time as i64);
+                out.push(b'}');
+                true
+            }
+            _ => {
+                error!("Ignoring unknown message type: {}", String::from_utf8_lossy(fields.msg_type));
+                false
+            }
+        }
+    }
+
+    /// Writes the BOOKED, FILL or DONE of the report into `out` and returns where in it its `send_ns` slot is, from
+    /// the start of the report, or `None` before the connection authenticated. `recv_ns` is when the request that
+    /// caused it was read, see `clock`.
+    pub fn write_report(&self, out: &mut Vec<u8>, report: &Report, time: u64, recv_ns: u64) -> Option<usize> {
+        let Some(templates) = &self.templates else {
+            error!("Order before AUTHENTICATE");
+            return None;
+        };
+        let template = match report.kind {
+            ReportKind::Booked => &templates.booked,
+            ReportKind::Fill => &templates.fill,
+            ReportKind::Done(_) => &templates.done,
+        };
+        let send_ns = template.write(out, report.sequence, report.order_id, time, recv_ns);
+        if let ReportKind::Done(status) = report.kind {
+            out.extend_from_slice(match status {
+                Status::Cancelled => b",\"status\":\"CANCELLED\"".as_slice(),
+                Status::Filled => b",\"status\":\"FILLED\"",
+                Status::Rejected => b",\"status\":\"REJECTED\"",
+            });
+        } else {
+            out.extend_from_slice(match report.side {
+                Side::Buy => b",\"side\":\"BUY\",\"amount\":\"".as_slice(),
+                Side::Sell => b",\"side\":\"SELL\",\"amount\":\"",
+            });
+            push_integer(out, report.amount);
+            if report.kind == ReportKind::Fill {
+                out.extend_from_slice(b"\",\"remaining\":\"");
+                push_integer(out, report.remaining);
+            }
+            out.extend_from_slice(b"\",\"price\":\"");
+            push_integer(out, report.price);
+            out.push(b'"');
+        }
+        out.extend_from_slice(b",\"instrument_code\":\"");
+        out.extend_from_slice(report.instrument.as_bytes());
+        out.extend_from_slice(b"\",\"client_id\":\"");
+        out.extend_from_slice(report.client_id.as_bytes());
+        out.extend_from_slice(b"\"}");
+        Some(send_ns)
+    }
+}
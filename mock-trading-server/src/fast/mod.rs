@@ -0,0 +1,864 @@
+//! Low overhead mode of the mock server, started with `--fast`. Every core runs its own thread with its own epoll
+//! instance and its own SO_REUSEPORT listeners, and the kernel spreads connections over them, so a connection is
+//! served start to finish by one thread and nothing is shared between threads. There are no actors, no tasks and no
+//! allocations per message: requests are scanned in place in the read buffer (see `json`) and responses are built
+//! in a per-connection write buffer.
+//!
+//! It speaks the same protocols as the default mode: the balances POST and WebSocket on the HTTP port, and length
+//! prefixed messages on the TCP port, each carrying JSON or binary order entry messages.
+//!
+//! With a delay profile, responses are held back per connection and a timer wheel per thread, woken up through a
+//! timerfd in the same epoll set, releases them when they are due; nothing ever sleeps on the event loop.
+//!
+//! Every thread has order books of its own, so orders only trade with orders of connections served by the same
+//! thread. Sharing books would mean sharing a lock between all cores.
+
+mod handshake;
+mod json;
+mod sys;
+mod timer_wheel;
+
+use std::collections::VecDeque;
+use std::io::{self, Read, Write};
+use std::mem;
+use std::net::{Ipv4Addr, SocketAddrV4, TcpListener, TcpStream};
+use std::os::unix::thread::JoinHandleExt;
+use std::sync::Arc;
+use std::thread;
+use std::time::{SystemTime, UNIX_EPOCH};
+
+use crate::affinity;
+use crate::binary_protocol::{self, Request, ServerTimes};
+use crate::clock::monotonic_nanos;
+use crate::delay::{self, DelayProfile};
+use crate::order_book::{Books, NewOrder, OrderKind, Report, Side};
+use timer_wheel::TimerWheel;
+
+const WEBSOCKET_LISTENER: u64 = 0;
+const TCP_LISTENER: u64 = 1;
+const TIMER: u64 = 2;
+const FIRST_CONNECTION: u64 = 3;
+const EVENT_CAPACITY: usize = 1024;
+const READ_CHUNK: usize = 64 * 1024;
+const LISTEN_BACKLOG: i32 = 1024;
+const TIMER_TICK_NANOS: u64 = 1_000;
+/// 65ms a turn at 1us a tick, longer delays wait for their turn in the slots.
+const TIMER_SLOTS: usize = 65_536;
+
+const OPCODE_TEXT: u8 = 0x1;
+const OPCODE_BINARY: u8 = 0x2;
+const OPCODE_CLOSE: u8 = 0x8;
+const OPCODE_PING: u8 = 0x9;
+const OPCODE_PONG: u8 = 0xA;
+
+#[derive(Clone)]
+pub struct Config {
+    pub http_port: u16,
+    pub tcp_port: u16,
+    pub threads: usize,
+    /// Cores to pin the threads to, round robin, or empty to leave them to the scheduler.
+    pub cores: Vec<usize>,
+    /// Poll epoll without blocking instead of sleeping in it, burning the cores for lower wake-up latency.
+    pub busy_poll: bool,
+    pub max_message_length: usize,
+    /// Holds every response back by a delay drawn from the profile, see `delay`.
+    pub delay: Option<Arc<DelayProfile>>,
+}
+
+/// Starts one event loop thread per `config.threads` and waits for them.
+pub fn run(config: Config) -> io::Result<()> {
+    info!(
+        "Starting fast server with {} threads{} on 0.0.0.0:{} (HTTP and WebSocket) and 0.0.0.0:{} (TCP){}{}",
+        config.threads,
+        if config.cores.is_empty() { String::new() } else { format!(" pinned to cores {:?}", config.cores) },
+        config.http_port,
+        config.tcp_port,
+        if config.busy_poll { ", busy polling" } else { "" },
+        if config.delay.is_some() { ", delaying responses" } else { "" }
+    );
+    let mut threads = Vec::with_capacity(config.threads);
+    for shard in 0..config.threads {
+        // bound here so a port that's taken fails the start instead of a thread
+        let websocket = sys::reuse_port_listener(SocketAddrV4::new(Ipv4Addr::UNSPECIFIED, config.http_port), LISTEN_BACKLOG)?;
+        let tcp = sys::reuse_port_listener(SocketAddrV4::new(Ipv4Addr::UNSPECIFIED, config.tcp_port), LISTEN_BACKLOG)?;
+        let mut event_loop = EventLoop::new(shard as u32, websocket, tcp, &config)?;
+        let thread = thread::Builder::new()
+            .name(format!("fast-{}", shard))
+            .spawn(move || event_loop.run())?;
+        if !config.cores.is_empty() {
+            let core = config.cores[shard % config.cores.len()];
+            affinity::pin(thread.as_pthread_t(), core).map_err(|e| {
+                io::Error::new(e.kind(), format!("could not pin fast-{} to core {}: {}", shard, core, e))
+            })?;
+        }
+        threads.push(thread);
+    }
+    for thread in threads {
+        if let Err(e) = thread.join().unwrap_or_else(|_| Err(io::Error::new(io::ErrorKind::Other, "event loop panicked"))) {
+            error!("Event loop failed: {}", e);
+        }
+    }
+    Ok(())
+}
+
+#[derive(Clone, Copy, PartialEq)]
+enum Framing {
+    /// Waiting for an HTTP request, which may upgrade the connection to WebSocket.
+    Http,
+    WebSocket,
+    LengthPrefixed,
+}
+
+/// Connection index and generation, which owns the orders the connection sent.
+type Owner = (usize, u64);
+
+/// A report for an order of another connection, written to it once the connection that traded is answered.
+struct Delivery {
+    owner: Owner,
+    binary: bool,
+    report: Report,
+    recv_ns: u64,
+}
+
+/// What answering a batch of messages needs besides the connection.
+struct Batch<'a> {
+    /// Milliseconds since the epoch.
+    time: u64,
+    recv_ns: u64,
+    config: &'a Config,
+    books: &'a mut Books<Owner>,
+    deliveries: &'a mut Vec<Delivery>,
+}
+
+/// Where a report carries its `send_ns`, from the start of the report or, once framed, of the frame.
+#[derive(Clone, Copy)]
+enum SendTime {
+    /// A JSON report's fixed width slot.
+    Json(usize),
+    /// A binary report's little endian u64.
+    Binary(usize),
+}
+
+impl SendTime {
+    fn shifted(self, by: usize) -> Self {
+        match self {
+            Self::Json(at) => Self::Json(at + by),
+            Self::Binary(at) => Self::Binary(at + by),
+        }
+    }
+
+    fn stamp(self, frame: &mut [u8], send_ns: u64) {
+        match self {
+            Self::Json(at) => json::stamp_send_ns(&mut frame[at..], send_ns),
+            Self::Binary(at) => frame[at..at + 8].copy_from_slice(&send_ns.to_le_bytes()),
+        }
+    }
+}
+
+/// Framed responses on their way to the socket.
+struct Outbox {
+    output: Vec<u8>,
+    /// Framed responses held back by the delay profile, and when each is due with its length and send time slot, in
+    /// order.
+    held: Vec<u8>,
+    due: VecDeque<(u64, usize, Option<SendTime>)>,
+    rng: delay::Rng,
+}
+
+impl Outbox {
+    /// Frames the payload, as a WebSocket frame with `opcode` or length prefixed without one, into the output, or
+    /// holds it back if there's a delay profile. `send_time` is where a report's payload has its send time, which is
+    /// stamped again when a held report is released.
+    fn send(&mut self, opcode: Option<u8>, payload: &[u8], recv_ns: u64, send_time: Option<SendTime>, config: &Config) {
+        if payload.is_empty() {
+            return;
+        }
+        let out = if config.delay.is_some() { &mut self.held } else { &mut self.output };
+        let start = out.len();
+        match opcode {
+            Some(opcode) => write_websocket_frame(out, opcode, payload),
+            None => {
+                out.extend_from_slice(&(payload.len() as u32).to_be_bytes());
+                out.extend_from_slice(payload);
+            }
+        }
+        let length = out.len() - start;
+        if let Some(delay) = &config.delay {
+            // never due before the response ahead of it, so responses keep the order of their requests
+            let previous = self.due.back().map_or(0, |&(deadline, _, _)| deadline);
+            let deadline = (recv_ns + delay.sample(&mut self.rng)).max(previous);
+            // the payload ends the frame
+            let send_time = send_time.map(|slot| slot.shifted(length - payload.len()));
+            self.due.push_back((deadline, length, send_time));
+        }
+    }
+
+    /// Moves the held responses due by `now` to the output, returns when the next one is due. Reports get their send
+    /// time now, so the delay counts as time in the venue, in `send_ns - recv_ns`, rather than on the network.
+    fn release(&mut self, now: u64) -> Option<u64> {
+        let mut released = 0;
+        let mut send_ns = None;
+        while let Some(&(deadline, length, send_time)) = self.due.front() {
+            if deadline > now {
+                break;
+            }
+            if let Some(send_time) = send_time {
+                let send_ns = *send_ns.get_or_insert_with(monotonic_nanos);
+                send_time.stamp(&mut self.held[released..released + length], send_ns);
+            }
+            released += length;
+            self.due.pop_front();
+        }
+        if released > 0 {
+            self.output.extend_from_slice(&self.held[..released]);
+            self.held.drain(..released);
+        }
+        self.due.front().map(|&(deadline, _, _)| deadline)
+    }
+}
+
+struct Connection {
+    stream: TcpStream,
+    framing: Framing,
+    input: Vec<u8>,
+    /// Bytes of `input` read but not yet answered.
+    filled: usize,
+    outbox: Outbox,
+    written: usize,
+    /// Response payload before it's framed into the outbox.
+    scratch: Vec<u8>,
+    responder: json::Responder,
+    waiting_for_writable: bool,
+    closing: bool,
+    /// Whether the timer wheel has an entry for this connection's earliest held response.
+    scheduled: bool,
+    index: usize,
+    /// Tells this connection apart from earlier ones in the same slot, whose timers and orders may still be around.
+    generation: u64,
+}
+
+enum Message<'a> {
+    Text(&'a [u8]),
+    Binary(&'a [u8]),
+}
+
+impl Connection {
+    fn new(stream: TcpStream, framing: Framing, shard: u32, index: usize, generation: u64) -> Self {
+        Self {
+            stream,
+            framing,
+            input: vec![0; READ_CHUNK],
+            filled: 0,
+            outbox: Outbox {
+                output: Vec::with_capacity(READ_CHUNK),
+                held: Vec::new(),
+                due: VecDeque::new(),
+                rng: delay::Rng::new(monotonic_nanos() ^ ((shard as u64) << 48) ^ generation),
+            },
+            written: 0,
+            scratch: Vec::with_capacity(1024),
+            responder: json::Responder::new(shard),
+            waiting_for_writable: false,
+            closing: false,
+            scheduled: false,
+            index,
+            generation,
+        }
+    }
+
+    fn owner(&self) -> Owner {
+        (self.index, self.generation)
+    }
+
+    /// Opcode of this connection's responses with their protocol, `None` for length prefixed ones.
+    fn opcode(&self, binary: bool) -> Option<u8> {
+        match self.framing {
+            Framing::LengthPrefixed => None,
+            _ if binary => Some(OPCODE_BINARY),
+            _ => Some(OPCODE_TEXT),
+        }
+    }
+
+    /// Reads everything the socket has, returns false once the peer has closed it.
+    fn read(&mut self) -> io::Result<bool> {
+        loop {
+            if self.filled == self.input.len() {
+                // only a message larger than the buffer gets here
+                self.input.resize(self.input.len() * 2, 0);
+            }
+            match self.stream.read(&mut self.input[self.filled..]) {
+                Ok(0) => return Ok(false),
+                Ok(n) => self.filled += n,
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => return Ok(true),
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                Err(e) => return Err(e),
+            }
+        }
+    }
+
+    /// Answers every complete message in the input buffer and keeps the incomplete rest.
+    fn process(&mut self, batch: &mut Batch) -> io::Result<()> {
+        let mut start = 0;
+        while !self.closing {
+            let consumed = match self.framing {
+                Framing::Http => self.process_http(start),
+                Framing::WebSocket => self.process_websocket_frame(start, batch)?,
+                Framing::LengthPrefixed => self.process_length_prefixed(start, batch)?,
+            };
+            if consumed == 0 {
+                break;
+            }
+            start += consumed;
+        }
+        self.input.copy_within(start..self.filled, 0);
+        self.filled -= start;
+        Ok(())
+    }
+
+    fn process_http(&mut self, start: usize) -> usize {
+        let Some((request, length)) = handshake::parse(&self.input[start..self.filled]) else {
+            return 0;
+        };
+        match request {
+            handshake::Request::Upgrade { key } => {
+                handshake::write_upgrade_response(&mut self.outbox.output, key);
+                self.framing = Framing::WebSocket;
+            }
+            handshake::Request::Other { path } => {
+                // POST /private/account/user/balances/{user_id}/{currency}/{amount}
+                let user_id = path.split(|&b| b == b'/').nth(5).unwrap_or_default();
+                let body = format!("User Created and balances sent for user: {}", String::from_utf8_lossy(user_id));
+                handshake::write_ok_response(&mut self.outbox.output, body.as_bytes());
+            }
+        }
+        length
+    }
+
+    fn process_websocket_frame(&mut self, start: usize, batch: &mut Batch) -> io::Result<usize> {
+        let buf = &mut self.input[start..self.filled];
+        if buf.len() < 2 {
+            return Ok(0);
+        }
+        let (b0, b1) = (buf[0], buf[1]);
+        if b0 & 0x80 == 0 || b0 & 0x70 != 0 || b1 & 0x80 == 0 {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "expected unfragmented, masked frames without extensions",
+            ));
+        }
+        let (length, mut header_length) = match b1 & 0x7F {
+            126 if buf.len() >= 4 => (u16::from_be_bytes([buf[2], buf[3]]) as usize, 4),
+            127 if buf.len() >= 10 => {
+                let mut bytes = [0u8; 8];
+                bytes.copy_from_slice(&buf[2..10]);
+                (u64::from_be_bytes(bytes) as usize, 10)
+            }
+            126 | 127 => return Ok(0),
+            length => (length as usize, 2),
+        };
+        if length > batch.config.max_message_length {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "frame is too long"));
+        }
+        header_length += 4;
+        if buf.len() < header_length + length {
+            return Ok(0);
+        }
+        let mask = [
+            buf[header_length - 4],
+            buf[header_length - 3],
+            buf[header_length - 2],
+            buf[header_length - 1],
+        ];
+        let payload = &mut buf[header_length..header_length + length];
+        for (i, byte) in payload.iter_mut().enumerate() {
+            *byte ^= mask[i & 3];
+        }
+        let payload = &self.input[start + header_length..start + header_length + length];
+        let owner = self.owner();
+        let mut replies = Replies {
+            responder: &mut self.responder,
+            scratch: &mut self.scratch,
+            outbox: &mut self.outbox,
+            opcode: None,
+        };
+        match b0 & 0x0F {
+            OPCODE_TEXT => {
+                replies.opcode = Some(OPCODE_TEXT);
+                replies.respond(Message::Text(payload), owner, batch);
+            }
+            OPCODE_BINARY => {
+                replies.opcode = Some(OPCODE_BINARY);
+                replies.respond(Message::Binary(payload), owner, batch);
+            }
+            OPCODE_PING => write_websocket_frame(&mut self.outbox.output, OPCODE_PONG, payload),
+            OPCODE_CLOSE => {
+                write_websocket_frame(&mut self.outbox.output, OPCODE_CLOSE, payload);
+                self.closing = true;
+            }
+            _ => {}
+        }
+        Ok(header_length + length)
+    }
+
+    fn process_length_prefixed(&mut self, start: usize, batch: &mut Batch) -> io::Result<usize> {
+        let buf = &self.input[start..self.filled];
+        if buf.len() < 4 {
+            return Ok(0);
+        }
+        let length = u32::from_be_bytes([buf[0], buf[1], buf[2], buf[3]]) as usize;
+        if length > batch.config.max_message_length {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "message is too long"));
+        }
+        if buf.len() < 4 + length {
+            return Ok(0);
+        }
+        let payload = &buf[4..4 + length];
+        // JSON starts with '{', which no binary header does
+        let message = if payload.first() == Some(&b'{') {
+            Message::Text(payload)
+        } else {
+            Message::Binary(payload)
+        };
+        let owner = self.owner();
+        let mut replies = Replies {
+            responder: &mut self.responder,
+            scratch: &mut self.scratch,
+            outbox: &mut self.outbox,
+            opcode: None,
+        };
+        replies.respond(message, owner, batch);
+        Ok(4 + length)
+    }
+
+    /// Writes as much of the output as the socket takes, returns true once it's all written.
+    fn flush(&mut self) -> io::Result<bool> {
+        while self.written < self.outbox.output.len() {
+            match self.stream.write(&self.outbox.output[self.written..]) {
+                Ok(n) => self.written += n,
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => return Ok(false),
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                Err(e) => return Err(e),
+            }
+        }
+        self.outbox.output.clear();
+        self.written = 0;
+        Ok(true)
+    }
+}
+
+/// Where the responses to the messages of one connection go.
+struct Replies<'a> {
+    responder: &'a mut json::Responder,
+    scratch: &'a mut Vec<u8>,
+    outbox: &'a mut Outbox,
+    /// WebSocket opcode the message came in with, `None` for length prefixed messages.
+    opcode: Option<u8>,
+}
+
+impl Replies<'_> {
+    /// Sends the responses to the message. Orders go to the books, and what they report for orders of other
+    /// connections is left in the batch's deliveries.
+    fn respond(&mut self, message: Message, owner: Owner, batch: &mut Batch) {
+        let Batch {
+            time,
+            recv_ns,
+            config,
+            books,
+            deliveries,
+        } = batch;
+        let (time, recv_ns, config) = (*time, *recv_ns, *config);
+        let (responder, scratch, outbox, opcode) = (&mut *self.responder, &mut *self.scratch, &mut *self.outbox, self.opcode);
+        let on_report = |report_owner: Owner, binary: bool, report: &Report| {
+            if report_owner != owner {
+                deliveries.push(Delivery {
+                    owner: report_owner,
+                    binary,
+                    report: *report,
+                    recv_ns,
+                });
+                return;
+            }
+            scratch.clear();
+            if let Some(send_time) = write_report(responder, scratch, binary, report, time, recv_ns) {
+                outbox.send(opcode, scratch, recv_ns, Some(send_time), config);
+            }
+        };
+        match message {
+            Message::Text(text) => {
+                let Some(fields) = json::scan(text) else {
+                    error!("Payload is invalid JSON: {}", String::from_utf8_lossy(text));
+                    return;
+                };
+                match fields.msg_type {
+                    b"CREATE_ORDER" | b"CANCEL_ORDER" if !responder.is_authenticated() => {
+                        error!("{} before AUTHENTICATE", String::from_utf8_lossy(fields.msg_type));
+                    }
+                    b"CREATE_ORDER" => books.submit(
+                        fields.instrument_code,
+                        &NewOrder {
+                            owner,
+                            binary: false,
+                            client_id: fields.client_id,
+                            kind: OrderKind::from_json(fields.order_type, fields.time_in_force),
+                            side: if fields.side == b"SELL" { Side::Sell } else { Side::Buy },
+                            // anything but an integer is rejected by the book, as a price of 0
+                            price: json::parse_integer(fields.price).unwrap_or(0),
+                            amount: json::parse_integer(fields.amount).unwrap_or(0),
+                        },
+                        on_report,
+                    ),
+                    b"CANCEL_ORDER" => books.cancel(fields.instrument_code, owner, false, fields.client_id, on_report),
+                    _ => {
+                        scratch.clear();
+                        if responder.respond(&fields, time, scratch) {
+                            outbox.send(opcode, scratch, recv_ns, None, config);
+                        }
+                    }
+                }
+            }
+            Message::Binary(bin) => match binary_protocol::decode(bin) {
+                Some(Request::CreateOrder(order)) => books.submit(
+                    nul_terminated(&order.instrument),
+                    &NewOrder {
+                        owner,
+                        binary: true,
+                        client_id: &order.client_order_id,
+                        kind: order.kind(),
+                        side: if order.side == binary_protocol::SIDE_SELL { Side::Sell } else { Side::Buy },
+                        price: order.price,
+                        amount: order.amount,
+                    },
+                    on_report,
+                ),
+                Some(Request::CancelOrder(cancel)) => {
+                    books.cancel(nul_terminated(&cancel.instrument), owner, true, &cancel.client_order_id, on_report)
+                }
+                None => error!("Ignoring unknown binary message of {} bytes", bin.len()),
+            },
+        }
+    }
+}
+
+/// Writes the report in the protocol of its order and returns where its send time is, from where the report starts,
+/// or `None` if there's nothing to send.
+fn write_report(
+    responder: &json::Responder,
+    out: &mut Vec<u8>,
+    binary: bool,
+    report: &Report,
+    time: u64,
+    recv_ns: u64,
+) -> Option<SendTime> {
+    if binary {
+        let start = out.len();
+        binary_protocol::write_report(
+            out,
+            report,
+            time,
+            ServerTimes {
+                recv_ns,
+                send_ns: monotonic_nanos(),
+            },
+        );
+        // binary reports end with send_ns
+        Some(SendTime::Binary(out.len() - start - 8))
+    } else {
+        responder.write_report(out, report, time, recv_ns).map(SendTime::Json)
+    }
+}
+
+fn nul_terminated(bytes: &[u8]) -> &[u8] {
+    &bytes[..bytes.iter().position(|&b| b == 0).unwrap_or(bytes.len())]
+}
+
+fn write_websocket_frame(out: &mut Vec<u8>, opcode: u8, payload: &[u8]) {
+    if payload.is_empty() && (opcode == OPCODE_TEXT || opcode == OPCODE_BINARY) {
+        return;
+    }
+    out.push(0x80 | opcode);
+    if payload.len() < 126 {
+        out.push(payload.len() as u8);
+    } else if payload.len() <= u16::MAX as usize {
+        out.push(126);
+        out.extend_from_slice(&(payload.len() as u16).to_be_bytes());
+    } else {
+        out.push(127);
+        out.extend_from_slice(&(payload.len() as u64).to_be_bytes());
+    }
+    out.extend_from_slice(payload);
+}
+
+/// Releases held responses on time, only there when `Config::delay` is set.
+struct Delays {
+    timer: sys::Timer,
+    /// Connections by index and generation.
+    wheel: TimerWheel<(usize, u64)>,
+    /// What the timer is set to, if it hasn't fired yet.
+    armed: Option<u64>,
+    expired: Vec<(usize, u64)>,
+}
+
+impl Delays {
+    /// Releases what's due of the connection's held responses and has the wheel wake it up for the rest.
+    fn release(&mut self, connection: &mut Connection, index: usize, now: u64) {
+        if let Some(deadline) = connection.outbox.release(now) {
+            if !connection.scheduled {
+                self.wheel.insert(deadline, (index, connection.generation));
+                connection.scheduled = true;
+            }
+        }
+    }
+
+    /// Sets the timer for the earliest timer in the wheel.
+    fn arm(&mut self) -> io::Result<()> {
+        if let Some(deadline) = self.wheel.next_deadline() {
+            if self.armed != Some(deadline) {
+                self.timer.set(deadline)?;
+                self.armed = Some(deadline);
+            }
+        }
+        Ok(())
+    }
+}
+
+struct EventLoop {
+    shard: u32,
+    epoll: sys::Epoll,
+    websocket: TcpListener,
+    tcp: TcpListener,
+    connections: Vec<Option<Connection>>,
+    free: Vec<usize>,
+    next_generation: u64,
+    delays: Option<Delays>,
+    books: Books<Owner>,
+    /// Filled while a connection is answered, emptied right after.
+    deliveries: Vec<Delivery>,
+    config: Config,
+}
+
+impl EventLoop {
+    fn new(shard: u32, websocket: TcpListener, tcp: TcpListener, config: &Config) -> io::Result<Self> {
+        let epoll = sys::Epoll::new()?;
+        epoll.add(&websocket, WEBSOCKET_LISTENER, sys::READABLE)?;
+        epoll.add(&tcp, TCP_LISTENER, sys::READABLE)?;
+        let delays = match config.delay {
+            Some(_) => {
+                let timer = sys::Timer::new()?;
+                epoll.add(&timer, TIMER, sys::READABLE)?;
+                Some(Delays {
+                    timer,
+                    wheel: TimerWheel::new(TIMER_TICK_NANOS, TIMER_SLOTS, monotonic_nanos()),
+                    armed: None,
+                    expired: Vec::new(),
+                })
+            }
+            None => None,
+        };
+        Ok(Self {
+            shard,
+            epoll,
+            websocket,
+            tcp,
+            connections: Vec::new(),
+            free: Vec::new(),
+            next_generation: 0,
+            delays,
+            books: Books::new(),
+            deliveries: Vec::new(),
+            config: config.clone(),
+        })
+    }
+
+    fn run(&mut self) -> io::Result<()> {
+        let mut events = sys::empty_events(EVENT_CAPACITY);
+        let timeout = if self.config.busy_poll { 0 } else { -1 };
+        loop {
+            let count = self.epoll.wait(&mut events, timeout)?;
+            if count == 0 {
+                continue;
+            }
+            // one clock read per batch of events instead of one per message
+            let time = SystemTime::now().duration_since(UNIX_EPOCH).unwrap().as_millis() as u64;
+            for event in &events[..count] {
+                let (token, ready) = (event.u64, event.events);
+                match token {
+                    WEBSOCKET_LISTENER => self.accept(Framing::Http),
+                    TCP_LISTENER => self.accept(Framing::LengthPrefixed),
+                    TIMER => self.expire(),
+                    _ => self.serve((token - FIRST_CONNECTION) as usize, ready, time),
+                }
+            }
+            if let Some(delays) = self.delays.as_mut() {
+                delays.arm()?;
+            }
+        }
+    }
+
+    /// Releases the held responses the timer woke the loop up for.
+    fn expire(&mut self) {
+        let Some(delays) = self.delays.as_mut() else {
+            return;
+        };
+        delays.timer.clear();
+        delays.armed = None;
+        let now = monotonic_nanos();
+        let mut expired = mem::take(&mut delays.expired);
+        delays.wheel.expire(now, |connection| expired.push(connection));
+        for &(index, generation) in &expired {
+            let Some(connection) = self.connections[index].as_mut() else {
+                continue;
+            };
+            if connection.generation != generation {
+                continue;
+            }
+            connection.scheduled = false;
+            let delays = self.delays.as_mut().unwrap();
+            delays.release(connection, index, now);
+            match Self::flush(&self.epoll, connection, index) {
+                Ok(flushed) if !(connection.closing && flushed) => {}
+                Ok(_) => self.close(index),
+                Err(e) => {
+                    debug!("Closing connection: {}", e);
+                    self.close(index);
+                }
+            }
+        }
+        expired.clear();
+        self.delays.as_mut().unwrap().expired = expired;
+    }
+
+    fn accept(&mut self, framing: Framing) {
+        let listener = if framing == Framing::Http { &self.websocket } else { &self.tcp };
+        loop {
+            let stream = match listener.accept() {
+                Ok((stream, peer)) => {
+                    info!("Connection received from {} on fast-{}", peer, self.shard);
+                    stream
+                }
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => return,
+                Err(e) => {
+                    error!("Failed to accept connection: {}", e);
+                    return;
+                }
+            };
+            if let Err(e) = stream.set_nonblocking(true).and_then(|_| stream.set_nodelay(true)) {
+                error!("Failed to set up connection: {}", e);
+                continue;
+            }
+            let index = self.free.pop().unwrap_or_else(|| {
+                self.connections.push(None);
+                self.connections.len() - 1
+            });
+            let token = index as u64 + FIRST_CONNECTION;
+            if let Err(e) = self.epoll.add(&stream, token, sys::READABLE) {
+                error!("Failed to register connection: {}", e);
+                self.free.push(index);
+                continue;
+            }
+            self.next_generation += 1;
+            self.connections[index] = Some(Connection::new(stream, framing, self.shard, index, self.next_generation));
+        }
+    }
+
+    fn serve(&mut self, index: usize, ready: u32, time: u64) {
+        let Some(connection) = self.connections[index].as_mut() else {
+            return;
+        };
+        let mut batch = Batch {
+            time,
+            recv_ns: 0,
+            config: &self.config,
+            books: &mut self.books,
+            deliveries: &mut self.deliveries,
+        };
+        match Self::serve_connection(&self.epoll, self.delays.as_mut(), connection, index, ready, &mut batch) {
+            Ok(true) => {}
+            Ok(false) => self.close(index),
+            Err(e) => {
+                debug!("Closing connection: {}", e);
+                self.close(index);
+            }
+        }
+        if !self.deliveries.is_empty() {
+            self.deliver(time);
+        }
+    }
+
+    /// Writes the reports other connections' orders got while a connection was answered to their connections.
+    fn deliver(&mut self, time: u64) {
+        let mut deliveries = mem::take(&mut self.deliveries);
+        for delivery in deliveries.drain(..) {
+            let (index, generation) = delivery.owner;
+            let Some(connection) = self.connections[index].as_mut() else {
+                continue;
+            };
+            if connection.generation != generation {
+                continue;
+            }
+            let opcode = connection.opcode(delivery.binary);
+            let scratch = &mut connection.scratch;
+            scratch.clear();
+            let responder = &connection.responder;
+            let Some(send_time) = write_report(responder, scratch, delivery.binary, &delivery.report, time, delivery.recv_ns)
+            else {
+                continue;
+            };
+            connection.outbox.send(opcode, scratch, delivery.recv_ns, Some(send_time), &self.config);
+            if let Some(delays) = self.delays.as_mut() {
+                delays.release(connection, index, monotonic_nanos());
+            }
+            match Self::flush(&self.epoll, connection, index) {
+                Ok(flushed) if !(connection.closing && flushed) => {}
+                Ok(_) => self.close(index),
+                Err(e) => {
+                    debug!("Closing connection: {}", e);
+                    self.close(index);
+                }
+            }
+        }
+        self.deliveries = deliveries;
+    }
+
+    /// Returns false once the connection should be closed.
+    fn serve_connection(
+        epoll: &sys::Epoll,
+        delays: Option<&mut Delays>,
+        connection: &mut Connection,
+        index: usize,
+        ready: u32,
+        batch: &mut Batch,
+    ) -> io::Result<bool> {
+        let mut open = true;
+        if ready & sys::READABLE != 0 || ready & sys::WRITABLE == 0 {
+            open = connection.read()?;
+            batch.recv_ns = monotonic_nanos();
+            connection.process(batch)?;
+            if let Some(delays) = delays {
+                delays.release(connection, index, monotonic_nanos());
+            }
+        }
+        // everything answered in this batch goes out in one write
+        let flushed = Self::flush(epoll, connection, index)?;
+        Ok(open && !(connection.closing && flushed))
+    }
+
+    /// Writes what the socket takes and waits for it to become writable again if that isn't everything.
+    fn flush(epoll: &sys::Epoll, connection: &mut Connection, index: usize) -> io::Result<bool> {
+        let flushed = connection.flush()?;
+        if flushed == connection.waiting_for_writable {
+            let interest = if flushed { sys::READABLE } else { sys::READABLE | sys::WRITABLE };
+            epoll.modify(&connection.stream, index as u64 + FIRST_CONNECTION, interest)?;
+            connection.waiting_for_writable = !flushed;
+        }
+        Ok(flushed)
+    }
+
+    fn close(&mut self, index: usize) {
+        if let Some(connection) = &self.connections[index] {
+            self.books.cancel_all(connection.owner());
+        }
+        // dropping the stream closes the socket, which also takes it out of the epoll set
+        self.connections[index] = None;
+        self.free.push(index);
+    }
+}
@@ -0,0 +1,99 @@
+//! Hashed timer wheel: timers go into the slot of their tick, so scheduling and expiring are O(1) per timer however
+//! many are pending, and a bitmap of occupied slots finds the next one to wake up for. Timers further out than one
+//! turn of the wheel share slots with nearer ones and are skipped until their turn comes.
+
+pub struct TimerWheel<T> {
+    tick_nanos: u64,
+    /// Items with the tick they're due at.
+    slots: Vec<Vec<(u64, T)>>,
+    /// Takes a slot's items while it's expired, kept around so expiring doesn't allocate.
+    spare: Vec<(u64, T)>,
+    occupied: Vec<u64>,
+    /// First tick not expired yet.
+    current: u64,
+    len: usize,
+}
+
+impl<T> TimerWheel<T> {
+    /// `slot_count` is rounded up to a multiple of 64 and a power of two.
+    pub fn new(tick_nanos: u64, slot_count: usize, now_nanos: u64) -> Self {
+        let slot_count = slot_count.max(64).next_power_of_two();
+        Self {
+            tick_nanos,
+            slots: (0..slot_count).map(|_| Vec::new()).collect(),
+            spare: Vec::new(),
+            occupied: vec![0; slot_count / 64],
+            current: now_nanos / tick_nanos,
+            len: 0,
+        }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Schedules `item` for the first tick at or after `deadline_nanos`, or the next tick if that's already past.
+    pub fn insert(&mut self, deadline_nanos: u64, item: T) {
+        let tick = ((deadline_nanos + self.tick_nanos - 1) / self.tick_nanos).max(self.current);
+        let slot = self.slot(tick);
+        self.slots[slot].push((tick, item));
+        self.occupied[slot / 64] |= 1 << (slot % 64);
+        self.len += 1;
+    }
+
+    /// Calls `expired` with every item due by `now_nanos`, in the order they are due.
+    pub fn expire(&mut self, now_nanos: u64, mut expired: impl FnMut(T)) {
+        let target = now_nanos / self.tick_nanos;
+        if target < self.current {
+            return;
+        }
+        let ticks = (target - self.current + 1).min(self.slots.len() as u64);
+        let mut offset = 0;
+        while let Some(next) = self.next_occupied(offset, ticks) {
+            let slot = self.slot(self.current + next);
+            std::mem::swap(&mut self.slots[slot], &mut self.spare);
+            for (tick, item) in self.spare.drain(..) {
+                if tick > target {
+                    // due in a later turn
+                    self.slots[slot].push((tick, item));
+                } else {
+                    self.len -= 1;
+                    expired(item);
+                }
+            }
+            if self.slots[slot].is_empty() {
+                self.occupied[slot / 64] &= !(1 << (slot % 64));
+            }
+            offset = next + 1;
+        }
+        self.current = target + 1;
+    }
+
+    /// When the earliest occupied slot is due, or `None` if there are no timers. Can be early when that slot only
+    /// has timers of a later turn.
+    pub fn next_deadline(&self) -> Option<u64> {
+        if self.is_empty() {
+            return None;
+        }
+        self.next_occupied(0, self.slots.len() as u64)
+            .map(|offset| (self.current + offset) * self.tick_nanos)
+    }
+
+    fn slot(&self, tick: u64) -> usize {
+        (tick as usize) & (self.slots.len() - 1)
+    }
+
+    /// Ticks after `current` of the first occupied slot within `offset..limit`.
+    fn next_occupied(&self, mut offset: u64, limit: u64) -> Option<u64> {
+        while offset < limit {
+            let slot = self.slot(self.current + offset);
+            let bits = self.occupied[slot / 64] >> (slot % 64);
+            if bits != 0 {
+                let next = offset + bits.trailing_zeros() as u64;
+                return if next < limit { Some(next) } else { None };
+            }
+            offset += 64 - (slot % 64) as u64;
+        }
+        None
+    }
+}
@@ -1,15 +1,36 @@
 use actix_web::middleware::Logger;
 use actix_web::{get, post, web, App, Error, HttpRequest, HttpResponse, HttpServer, Responder};
 use actix_web_actors::ws;
+use std::cell::Cell;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Arc;
 
 #[macro_use]
 extern crate log;
 extern crate env_logger;
 
+mod affinity;
+mod binary_protocol;
+mod clock;
+mod delay;
+mod exchange;
+mod fast;
+mod order_book;
+mod order_entry;
+mod tcp;
 mod websocket;
 mod websocket_message_types;
+use self::delay::DelayProfile;
+use self::exchange::Exchange;
 use self::websocket::WebSocketActor;
 
+/// Default port of the REST API and WebSocket server, `--port`.
+const HTTP_PORT: u16 = 8888;
+/// Default port of the length prefixed TCP listener, the client's TCP_PORT, `--tcp-port`.
+const TCP_PORT: u16 = 8889;
+/// Same limit as the client's MAX_FRAME_PAYLOAD_LENGTH.
+const MAX_MESSAGE_LENGTH: usize = 1280000;
+
 #[post("/private/account/user/balances/{user_id}/{currency}/{amount}")]
 async fn add_balances(path: actix_web::web::Path<(i32, String, i32)>) -> impl Responder {
     let (user_id, currency, amount) = path.into_inner();
@@ -24,26 +45,116 @@ async fn add_balances(path: actix_web::web::Path<(i32, String, i32)>) -> impl Re
 }
 
 #[get("/")]
-async fn ws_index(req: HttpRequest, stream: web::Payload) -> Result<HttpResponse, Error> {
+async fn ws_index(
+    req: HttpRequest,
+    stream: web::Payload,
+    exchange: web::Data<Exchange>,
+    delay: web::Data<Option<Arc<DelayProfile>>>,
+) -> Result<HttpResponse, Error> {
     info!("Websocket connection received");
-    let resp = ws::start(WebSocketActor::new(), &req, stream);
+    let actor = WebSocketActor::new(exchange.into_inner(), delay.get_ref().clone());
+    let resp = ws::start(actor, &req, stream);
     info!("Websocket response: {:?}", resp);
     resp
 }
 
-#[actix_web::main]
-async fn main() -> std::io::Result<()> {
+fn main() -> std::io::Result<()> {
     env_logger::init_from_env(env_logger::Env::default().default_filter_or("info"));
 
-    info!("Starting server on 0.0.0.0:8888");
+    let args: Vec<String> = std::env::args().collect();
+    let delay = match arg_value(&args, "--delay") {
+        Some(profile) => Some(Arc::new(DelayProfile::parse(profile)?)),
+        None => None,
+    };
+    let http_port = parsed_arg(&args, "--port", HTTP_PORT)?;
+    let tcp_port = parsed_arg(&args, "--tcp-port", TCP_PORT)?;
+    let cores = match arg_value(&args, "--cores") {
+        Some(list) => affinity::parse_core_list(list)?,
+        None => Vec::new(),
+    };
+    // a thread per pinned core, or else per core the server may run on
+    let default_workers = if cores.is_empty() {
+        std::thread::available_parallelism().map_or(1, |n| n.get())
+    } else {
+        cores.len()
+    };
+    let workers = parsed_arg(&args, "--workers", default_workers)?.max(1);
+    if args.iter().any(|arg| arg == "--fast") {
+        return fast::run(fast::Config {
+            http_port,
+            tcp_port,
+            threads: workers,
+            cores,
+            busy_poll: args.iter().any(|arg| arg == "--busy-poll"),
+            max_message_length: MAX_MESSAGE_LENGTH,
+            delay,
+        });
+    }
+
+    let exchange = Arc::new(Exchange::new());
+    tcp::serve(("0.0.0.0", tcp_port), MAX_MESSAGE_LENGTH, exchange.clone(), delay.clone())?;
+    actix_web::rt::System::new().block_on(serve_actix(http_port, workers, cores, exchange, delay))
+}
+
+/// The argument following `name` on the command line.
+fn arg_value<'a>(args: &'a [String], name: &str) -> Option<&'a str> {
+    let position = args.iter().position(|arg| arg == name)?;
+    args.get(position + 1).map(String::as_str)
+}
+
+fn parsed_arg<T: std::str::FromStr>(args: &[String], name: &str, default: T) -> std::io::Result<T> {
+    match arg_value(args, name) {
+        Some(value) => value.parse().map_err(|_| {
+            std::io::Error::new(std::io::ErrorKind::InvalidInput, format!("invalid {} '{}'", name, value))
+        }),
+        None => Ok(default),
+    }
+}
+
+thread_local! {
+    static PINNED: Cell<bool> = Cell::new(false);
+}
+
+/// Pins the calling actix worker to the next of `cores`, once per worker however often it builds its app.
+fn pin_worker(cores: &[usize], next: &AtomicUsize) {
+    if cores.is_empty() || PINNED.with(|pinned| pinned.replace(true)) {
+        return;
+    }
+    let core = cores[next.fetch_add(1, Ordering::Relaxed) % cores.len()];
+    if let Err(e) = affinity::pin(unsafe { libc::pthread_self() }, core) {
+        error!("Could not pin worker to core {}: {}", core, e);
+    }
+}
+
+async fn serve_actix(
+    port: u16,
+    workers: usize,
+    cores: Vec<usize>,
+    exchange: Arc<Exchange>,
+    delay: Option<Arc<DelayProfile>>,
+) -> std::io::Result<()> {
+    info!(
+        "Starting server on 0.0.0.0:{} with {} workers{}",
+        port,
+        workers,
+        if cores.is_empty() { String::new() } else { format!(" pinned to cores {:?}", cores) }
+    );
 
-    HttpServer::new(|| {
+    let exchange = web::Data::from(exchange);
+    let delay = web::Data::new(delay);
+    let next_core = Arc::new(AtomicUsize::new(0));
+    // the factory runs on every worker thread as it starts
+    HttpServer::new(move || {
+        pin_worker(&cores, &next_core);
         App::new()
+            .app_data(exchange.clone())
+            .app_data(delay.clone())
             .wrap(Logger::default())
             .service(add_balances)
             .service(ws_index)
     })
-    .bind(("0.0.0.0", 8888))?
+    .workers(workers)
+    .bind(("0.0.0.0", port))?
     .run()
     .await
 }
@@ -0,0 +1,497 @@
+//! Price-time priority limit order books, one per instrument. Each side of a book is a ladder: an array of price
+//! levels indexed by the price's distance from the ladder's lowest price, so finding a level is an index and the best
+//! price moves by looking at the neighbouring slots. Resting orders live in one slab per book and every level queues
+//! its orders through links kept in the orders themselves, so adding, filling and cancelling don't allocate once the
+//! slab has grown, and a cancel takes an order out of the middle of its queue in O(1).
+//!
+//! Prices and amounts are integers in whatever unit the client uses. Everything that happens to an order is handed
+//! to a callback as a `Report` for its owner, who may be another connection than the one that sent the request.
+
+use std::collections::HashMap;
+use std::hash::Hash;
+
+/// Order book sequences start here so they always have 19 digits without leading zeros.
+pub const FIRST_SEQUENCE: u64 = 1_000_000_000_000_000_000;
+pub const MAX_CLIENT_ID_LENGTH: usize = 48;
+pub const INSTRUMENT_LENGTH: usize = 16;
+/// Widest price range, in price units, one side of a book spans.
+const MAX_LEVELS: usize = 1 << 20;
+const NIL: u32 = u32::MAX;
+
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum Side {
+    Buy,
+    Sell,
+}
+
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum Status {
+    Cancelled,
+    Filled,
+    /// Invalid order, or a cancel for an order that isn't in the book (anymore).
+    Rejected,
+}
+
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum ReportKind {
+    Booked,
+    Fill,
+    Done(Status),
+}
+
+/// How an order trades. Immediate or cancel and market orders trade what they can when they come in and are cancelled
+/// for the rest instead of being booked.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum OrderKind {
+    Limit,
+    ImmediateOrCancel,
+    /// Trades at any price, its own is ignored.
+    Market,
+}
+
+impl OrderKind {
+    /// From the `type` and `time_in_force` of a JSON order; anything unknown is a good till cancelled limit order.
+    pub fn from_json(order_type: &[u8], time_in_force: &[u8]) -> Self {
+        match (order_type, time_in_force) {
+            (b"MARKET", _) => OrderKind::Market,
+            (_, b"IMMEDIATE_OR_CANCELLED") => OrderKind::ImmediateOrCancel,
+            _ => OrderKind::Limit,
+        }
+    }
+}
+
+/// Short byte string kept inline so orders and reports stay plain data.
+#[derive(Clone, Copy, PartialEq, Eq, Hash)]
+pub struct InlineBytes<const N: usize> {
+    len: u8,
+    bytes: [u8; N],
+}
+
+impl<const N: usize> InlineBytes<N> {
+    /// `None` if `bytes` is longer than `N`.
+    pub fn new(bytes: &[u8]) -> Option<Self> {
+        (bytes.len() <= N).then(|| Self::truncated(bytes))
+    }
+
+    pub fn truncated(bytes: &[u8]) -> Self {
+        let len = bytes.len().min(N);
+        let mut inline = Self { len: len as u8, bytes: [0; N] };
+        inline.bytes[..len].copy_from_slice(&bytes[..len]);
+        inline
+    }
+
+    pub fn as_bytes(&self) -> &[u8] {
+        &self.bytes[..self.len as usize]
+    }
+}
+
+pub type ClientId = InlineBytes<MAX_CLIENT_ID_LENGTH>;
+pub type Instrument = InlineBytes<INSTRUMENT_LENGTH>;
+
+/// What a BOOKED, FILL or DONE tells the owner of an order.
+#[derive(Clone, Copy)]
+pub struct Report {
+    pub kind: ReportKind,
+    pub client_id: ClientId,
+    pub instrument: Instrument,
+    pub order_id: u64,
+    pub sequence: u64,
+    pub side: Side,
+    /// BOOKED: the order's limit. FILL: the price it traded at, the resting order's.
+    pub price: i64,
+    /// BOOKED: what rests in the book. FILL: what traded. DONE: what was left of the order.
+    pub amount: i64,
+    /// FILL: what's left of the order after it.
+    pub remaining: i64,
+}
+
+/// An order as it comes in. `binary` tells which protocol the owner wants its reports in.
+pub struct NewOrder<'a, O> {
+    pub owner: O,
+    pub binary: bool,
+    pub client_id: &'a [u8],
+    pub kind: OrderKind,
+    pub side: Side,
+    pub price: i64,
+    pub amount: i64,
+}
+
+/// A resting order and its links in the queue of its price level.
+#[derive(Clone, Copy)]
+struct Node<O> {
+    prev: u32,
+    next: u32,
+    owner: O,
+    binary: bool,
+    side: Side,
+    price: i64,
+    remaining: i64,
+    order_id: u64,
+    client_id: ClientId,
+}
+
+#[derive(Clone, Copy)]
+struct Level {
+    head: u32,
+    tail: u32,
+}
+
+const EMPTY_LEVEL: Level = Level { head: NIL, tail: NIL };
+
+/// One side of a book.
+struct Ladder {
+    side: Side,
+    /// Price of `levels[0]`.
+    low: i64,
+    levels: Vec<Level>,
+    /// Index of the best level with orders.
+    best: Option<usize>,
+}
+
+impl Ladder {
+    fn new(side: Side) -> Self {
+        Self {
+            side,
+            low: 0,
+            levels: Vec::new(),
+            best: None,
+        }
+    }
+
+    fn find(&self, price: i64) -> Option<usize> {
+        let index = usize::try_from(price.checked_sub(self.low)?).ok()?;
+        (index < self.levels.len()).then_some(index)
+    }
+
+    /// Index of the level of `price`, growing the ladder to it. `None` if that makes it wider than `MAX_LEVELS`.
+    fn level_for(&mut self, price: i64) -> Option<usize> {
+        if self.levels.is_empty() {
+            self.low = price;
+            self.levels.push(EMPTY_LEVEL);
+            return Some(0);
+        }
+        if price < self.low {
+            let shift = usize::try_from(self.low - price).ok()?;
+            if shift + self.levels.len() > MAX_LEVELS {
+                return None;
+            }
+            let mut levels = vec![EMPTY_LEVEL; shift];
+            levels.extend_from_slice(&self.levels);
+            self.levels = levels;
+            self.low = price;
+            self.best = self.best.map(|best| best + shift);
+            return Some(0);
+        }
+        let index = usize::try_from(price - self.low).ok()?;
+        if index >= MAX_LEVELS {
+            return None;
+        }
+        if index >= self.levels.len() {
+            self.levels.resize(index + 1, EMPTY_LEVEL);
+        }
+        Some(index)
+    }
+
+    fn is_better(&self, index: usize, than: usize) -> bool {
+        match self.side {
+            Side::Buy => index > than,
+            Side::Sell => index < than,
+        }
+    }
+
+    /// Takes note of a level that has just got an order.
+    fn improve(&mut self, index: usize) {
+        if self.best.map_or(true, |best| self.is_better(index, best)) {
+            self.best = Some(index);
+        }
+    }
+
+    /// Moves `best` away from levels that ran out of orders.
+    fn settle(&mut self) {
+        let Some(mut index) = self.best else {
+            return;
+        };
+        loop {
+            if self.levels[index].head != NIL {
+                self.best = Some(index);
+                return;
+            }
+            match self.side {
+                Side::Buy if index > 0 => index -= 1,
+                Side::Sell if index + 1 < self.levels.len() => index += 1,
+                _ => break,
+            }
+        }
+        self.best = None;
+    }
+
+    fn best_price(&self) -> Option<i64> {
+        self.best.map(|best| self.low + best as i64)
+    }
+}
+
+struct OrderBook<O> {
+    instrument: Instrument,
+    bids: Ladder,
+    asks: Ladder,
+    nodes: Vec<Node<O>>,
+    free: Vec<u32>,
+    /// Resting orders by owner and client id, for cancels.
+    resting: HashMap<(O, ClientId), u32>,
+    sequence: u64,
+}
+
+impl<O: Copy + Eq + Hash> OrderBook<O> {
+    fn new(instrument: Instrument) -> Self {
+        Self {
+            instrument,
+            bids: Ladder::new(Side::Buy),
+            asks: Ladder::new(Side::Sell),
+            nodes: Vec::new(),
+            free: Vec::new(),
+            resting: HashMap::new(),
+            sequence: FIRST_SEQUENCE,
+        }
+    }
+
+    fn next_sequence(&mut self) -> u64 {
+        self.sequence += 1;
+        self.sequence
+    }
+
+    fn ladder(&mut self, side: Side) -> &mut Ladder {
+        match side {
+            Side::Buy => &mut self.bids,
+            Side::Sell => &mut self.asks,
+        }
+    }
+
+    fn report(&self, kind: ReportKind, node: &Node<O>, sequence: u64, price: i64, amount: i64) -> Report {
+        Report {
+            kind,
+            client_id: node.client_id,
+            instrument: self.instrument,
+            order_id: node.order_id,
+            sequence,
+            side: node.side,
+            price,
+            amount,
+            remaining: node.remaining,
+        }
+    }
+
+    /// Matches the order against the other side and books what's left of it, reporting FILLs to both owners of every
+    /// trade, DONE to owners of resting orders that are filled, and BOOKED or DONE for the new order. What's left of
+    /// an immediate or cancel or market order is cancelled instead of booked.
+    fn submit(&mut self, order: &NewOrder<O>, client_id: ClientId, order_id: u64, report: &mut impl FnMut(O, bool, &Report)) {
+        let mut taker = Node {
+            prev: NIL,
+            next: NIL,
+            owner: order.owner,
+            binary: order.binary,
+            side: order.side,
+            price: order.price,
+            remaining: order.amount,
+            order_id,
+            client_id,
+        };
+        let market = order.kind == OrderKind::Market;
+        let valid = (market || order.price > 0) && order.amount > 0 && !self.resting.contains_key(&(order.owner, client_id));
+        // found up front, so a limit order the ladder can't hold is rejected before it trades
+        let level = match order.kind {
+            OrderKind::Limit if valid => self.ladder(order.side).level_for(order.price),
+            _ => None,
+        };
+        if !valid || (order.kind == OrderKind::Limit && level.is_none()) {
+            let sequence = self.next_sequence();
+            report(order.owner, order.binary, &self.report(ReportKind::Done(Status::Rejected), &taker, sequence, order.price, order.amount));
+            return;
+        }
+
+        let opposite = match order.side {
+            Side::Buy => Side::Sell,
+            Side::Sell => Side::Buy,
+        };
+        while taker.remaining > 0 {
+            let ladder = self.ladder(opposite);
+            let Some(price) = ladder.best_price() else {
+                break;
+            };
+            let crosses = market
+                || match order.side {
+                    Side::Buy => price <= order.price,
+                    Side::Sell => price >= order.price,
+                };
+            if !crosses {
+                break;
+            }
+            let mut index = ladder.levels[ladder.best.unwrap()].head;
+            while index != NIL && taker.remaining > 0 {
+                let maker = &mut self.nodes[index as usize];
+                let traded = taker.remaining.min(maker.remaining);
+                maker.remaining -= traded;
+                taker.remaining -= traded;
+                let maker = *maker;
+                let sequence = self.next_sequence();
+                report(maker.owner, maker.binary, &self.report(ReportKind::Fill, &maker, sequence, price, traded));
+                report(taker.owner, taker.binary, &self.report(ReportKind::Fill, &taker, sequence, price, traded));
+                if maker.remaining == 0 {
+                    self.unlink(index);
+                    let sequence = self.next_sequence();
+                    report(maker.owner, maker.binary, &self.report(ReportKind::Done(Status::Filled), &maker, sequence, price, 0));
+                }
+                index = maker.next;
+            }
+        }
+
+        let sequence = self.next_sequence();
+        if taker.remaining == 0 {
+            report(taker.owner, taker.binary, &self.report(ReportKind::Done(Status::Filled), &taker, sequence, order.price, 0));
+            return;
+        }
+        let Some(level) = level else {
+            let remaining = taker.remaining;
+            report(taker.owner, taker.binary, &self.report(ReportKind::Done(Status::Cancelled), &taker, sequence, order.price, remaining));
+            return;
+        };
+        let index = match self.free.pop() {
+            Some(index) => index,
+            None => {
+                self.nodes.push(taker);
+                (self.nodes.len() - 1) as u32
+            }
+        };
+        let ladder = match order.side {
+            Side::Buy => &mut self.bids,
+            Side::Sell => &mut self.asks,
+        };
+        let tail = ladder.levels[level].tail;
+        taker.prev = tail;
+        if tail == NIL {
+            ladder.levels[level].head = index;
+        } else {
+            self.nodes[tail as usize].next = index;
+        }
+        ladder.levels[level].tail = index;
+        ladder.improve(level);
+        self.nodes[index as usize] = taker;
+        self.resting.insert((taker.owner, client_id), index);
+        report(taker.owner, taker.binary, &self.report(ReportKind::Booked, &taker, sequence, order.price, taker.remaining));
+    }
+
+    fn cancel(&mut self, owner: O, binary: bool, client_id: ClientId, report: &mut impl FnMut(O, bool, &Report)) {
+        let sequence = self.next_sequence();
+        match self.resting.get(&(owner, client_id)) {
+            Some(&index) => {
+                let node = self.nodes[index as usize];
+                self.unlink(index);
+                report(owner, node.binary, &self.report(ReportKind::Done(Status::Cancelled), &node, sequence, node.price, node.remaining));
+            }
+            None => {
+                let unknown = Node {
+                    prev: NIL,
+                    next: NIL,
+                    owner,
+                    binary,
+                    side: Side::Buy,
+                    price: 0,
+                    remaining: 0,
+                    order_id: 0,
+                    client_id,
+                };
+                report(owner, binary, &self.report(ReportKind::Done(Status::Rejected), &unknown, sequence, 0, 0));
+            }
+        }
+    }
+
+    /// Takes a resting order out of its level's queue and the book.
+    fn unlink(&mut self, index: u32) {
+        let node = self.nodes[index as usize];
+        let ladder = match node.side {
+            Side::Buy => &mut self.bids,
+            Side::Sell => &mut self.asks,
+        };
+        let level = ladder.find(node.price).expect("resting order outside its ladder");
+        if node.prev == NIL {
+            ladder.levels[level].head = node.next;
+        } else {
+            self.nodes[node.prev as usize].next = node.next;
+        }
+        if node.next == NIL {
+            ladder.levels[level].tail = node.prev;
+        } else {
+            self.nodes[node.next as usize].prev = node.prev;
+        }
+        ladder.settle();
+        self.nodes[index as usize].next = NIL;
+        self.free.push(index);
+        self.resting.remove(&(node.owner, node.client_id));
+    }
+}
+
+/// The books of every instrument, created on their first order. `O` tells the owners of orders apart.
+pub struct Books<O> {
+    books: HashMap<Instrument, OrderBook<O>>,
+    order_id: u64,
+}
+
+impl<O: Copy + Eq + Hash> Books<O> {
+    pub fn new() -> Self {
+        Self {
+            books: HashMap::new(),
+            order_id: 0,
+        }
+    }
+
+    fn book(&mut self, instrument: Instrument) -> &mut OrderBook<O> {
+        self.books.entry(instrument).or_insert_with(|| OrderBook::new(instrument))
+    }
+
+    /// Reports everything that happens because of the order through `report`, with the owner and protocol of the
+    /// order each report is about.
+    pub fn submit(&mut self, instrument: &[u8], order: &NewOrder<O>, mut report: impl FnMut(O, bool, &Report)) {
+        self.order_id += 1;
+        let order_id = self.order_id;
+        match (Instrument::new(instrument), ClientId::new(order.client_id)) {
+            (Some(instrument), Some(client_id)) => self.book(instrument).submit(order, client_id, order_id, &mut report),
+            _ => report(order.owner, order.binary, &rejected(instrument, order.client_id)),
+        }
+    }
+
+    pub fn cancel(&mut self, instrument: &[u8], owner: O, binary: bool, client_id: &[u8], mut report: impl FnMut(O, bool, &Report)) {
+        match (Instrument::new(instrument), ClientId::new(client_id)) {
+            (Some(instrument), Some(client_id)) => self.book(instrument).cancel(owner, binary, client_id, &mut report),
+            _ => report(owner, binary, &rejected(instrument, client_id)),
+        }
+    }
+
+    /// Takes every order of an owner that has gone out of the books, without reports.
+    pub fn cancel_all(&mut self, owner: O) {
+        for book in self.books.values_mut() {
+            let orders: Vec<u32> = book
+                .resting
+                .iter()
+                .filter(|((order_owner, _), _)| *order_owner == owner)
+                .map(|(_, &index)| index)
+                .collect();
+            for index in orders {
+                book.unlink(index);
+            }
+        }
+    }
+}
+
+fn rejected(instrument: &[u8], client_id: &[u8]) -> Report {
+    Report {
+        kind: ReportKind::Done(Status::Rejected),
+        client_id: ClientId::truncated(client_id),
+        instrument: Instrument::truncated(instrument),
+        order_id: 0,
+        // not from any book, but in the range of their sequences
+        sequence: FIRST_SEQUENCE,
+        side: Side::Buy,
+        price: 0,
+        amount: 0,
+        remaining: 0,
+    }
+}
@@ -0,0 +1,276 @@
+use serde_json::{json, Value};
+use std::sync::Arc;
+use std::time::{SystemTime, UNIX_EPOCH};
+
+use crate::binary_protocol::{self, Request, ServerTimes};
+use crate::clock::monotonic_nanos;
+use crate::exchange::{Exchange, Sink};
+use crate::order_book::{NewOrder, OrderKind, Report, ReportKind, Side, Status};
+use crate::websocket_message_types::*;
+
+pub enum Response {
+    Text(String),
+    Binary(Vec<u8>),
+}
+
+impl Response {
+    /// Sets the `send_ns` of a BOOKED, FILL or DONE to when it actually leaves, for a response a delay profile held
+    /// back after it was built. Other responses don't carry one and are left as they are.
+    pub fn stamp_send_ns(&mut self, send_ns: u64) {
+        match self {
+            Self::Text(text) => {
+                const KEY: &str = "\"send_ns\":";
+                if let Some(start) = text.find(KEY).map(|at| at + KEY.len()) {
+                    let end = text[start..].find(|c: char| !c.is_ascii_digit()).map_or(text.len(), |n| start + n);
+                    text.replace_range(start..end, &send_ns.to_string());
+                }
+            }
+            // every binary response is a report
+            Self::Binary(bin) => binary_protocol::stamp_send_ns(bin, send_ns),
+        }
+    }
+}
+
+/// Order entry state of one client connection, shared by the WebSocket and the TCP listener so both answer the
+/// same messages the same way.
+/// Orders go into the books of the `Exchange`, where they trade with the orders of every other session.
+pub struct Session {
+    exchange: Arc<Exchange>,
+    owner: u64,
+    user_id: Option<String>,
+}
+
+impl Session {
+    pub fn new(exchange: Arc<Exchange>) -> Self {
+        let owner = exchange.join();
+        Self {
+            exchange,
+            owner,
+            user_id: None,
+        }
+    }
+
+    /// Where responses for resting orders go when another session trades with them. Until it is set they are dropped.
+    pub fn set_sink(&self, sink: Sink) {
+        self.exchange.set_sink(self.owner, sink);
+    }
+
+    /// Responses to a JSON message, in the order they go out. `recv_ns` is when the message was read, see `clock`.
+    pub fn on_text(&mut self, text: &str, recv_ns: u64) -> Vec<Response> {
+        debug!("Received message: {}", text);
+        let Ok(payload): Result<Value, _> = serde_json::from_str(text) else {
+            error!("Payload is invalid JSON: {}", text);
+            return Vec::new();
+        };
+        let Some(payload_type) = payload["type"].as_str() else {
+            error!("Payload does not have a 'type' field: {}", payload);
+            return Vec::new();
+        };
+
+        match payload_type {
+            "AUTHENTICATE" => {
+                let auth_request: AuthRequest = serde_json::from_str(text).unwrap();
+                self.exchange.set_user_id(self.owner, &auth_request.api_token);
+                self.user_id = Some(auth_request.api_token);
+
+                vec![Response::Text(json!({"type": "AUTHENTICATED"}).to_string())]
+            }
+            "SUBSCRIBE" => {
+                let timestamp = SystemTime::now()
+                    .duration_since(UNIX_EPOCH)
+                    .unwrap()
+                    .as_millis();
+                let subscription_request: SubscriptionRequest = serde_json::from_str(text).unwrap();
+
+                let output_channels = subscription_request
+                    .channels
+                    .iter()
+                    .map(|channel| {
+                        json!({
+                            "account_id": self.user_id.as_ref().unwrap(),
+                            "name": channel.name
+                        })
+                    })
+                    .collect::<Vec<Value>>();
+
+                vec![Response::Text(
+                    json!({
+                        "type": "SUBSCRIPTIONS",
+                        "channels": output_channels,
+                        "time": timestamp,
+                    })
+                    .to_string(),
+                )]
+            }
+            "CREATE_ORDER" => {
+                let limit_order_request: LimitOrderRequest = serde_json::from_str(text).unwrap();
+                let order = limit_order_request.order;
+                let side = match order.side.as_str() {
+                    "SELL" => Side::Sell,
+                    _ => Side::Buy,
+                };
+                // anything but an integer is rejected by the book, as a price of 0
+                let mut reports = Vec::new();
+                self.exchange.submit(
+                    order.instrument_code.as_bytes(),
+                    &NewOrder {
+                        owner: self.owner,
+                        binary: false,
+                        client_id: order.client_id.as_bytes(),
+                        kind: OrderKind::from_json(order.r#type.as_bytes(), order.time_in_force.as_bytes()),
+                        side,
+                        price: order.price.parse().unwrap_or(0),
+                        amount: order.amount.parse().unwrap_or(0),
+                    },
+                    recv_ns,
+                    &mut reports,
+                );
+                self.format(&reports, false, recv_ns)
+            }
+            "CANCEL_ORDER" => {
+                let cancel_order_request: CancelOrderRequest = serde_json::from_str(text).unwrap();
+                let mut reports = Vec::new();
+                self.exchange.cancel(
+                    cancel_order_request.instrument_code.as_bytes(),
+                    self.owner,
+                    false,
+                    cancel_order_request.client_id.as_bytes(),
+                    &mut reports,
+                );
+                self.format(&reports, false, recv_ns)
+            }
+            _ => {
+                error!("Ignoring unknown message type: {}", payload);
+                Vec::new()
+            }
+        }
+    }
+
+    /// Responses to a binary order entry message, see `binary_protocol`.
+    pub fn on_binary(&mut self, bin: &[u8], recv_ns: u64) -> Vec<Response> {
+        let mut reports = Vec::new();
+        match binary_protocol::decode(bin) {
+            Some(Request::CreateOrder(order)) => self.exchange.submit(
+                nul_terminated(&order.instrument),
+                &NewOrder {
+                    owner: self.owner,
+                    binary: true,
+                    client_id: &order.client_order_id,
+                    kind: order.kind(),
+                    side: if order.side == binary_protocol::SIDE_SELL { Side::Sell } else { Side::Buy },
+                    price: order.price,
+                    amount: order.amount,
+                },
+                recv_ns,
+                &mut reports,
+            ),
+            Some(Request::CancelOrder(cancel)) => self.exchange.cancel(
+                nul_terminated(&cancel.instrument),
+                self.owner,
+                true,
+                &cancel.client_order_id,
+                &mut reports,
+            ),
+            None => error!("Ignoring unknown binary message of {} bytes", bin.len()),
+        }
+        self.format(&reports, true, recv_ns)
+    }
+
+    fn format(&self, reports: &[Report], binary: bool, recv_ns: u64) -> Vec<Response> {
+        reports
+            .iter()
+            .map(|report| format_report(report, binary, self.user_id.as_deref(), recv_ns))
+            .collect()
+    }
+}
+
+impl Drop for Session {
+    fn drop(&mut self) {
+        self.exchange.leave(self.owner);
+    }
+}
+
+fn nul_terminated(bytes: &[u8]) -> &[u8] {
+    &bytes[..bytes.iter().position(|&b| b == 0).unwrap_or(bytes.len())]
+}
+
+/// BOOKED, FILL or DONE telling `user_id` about one of its orders.
+pub fn format_report(report: &Report, binary: bool, user_id: Option<&str>, recv_ns: u64) -> Response {
+    let timestamp = SystemTime::now()
+        .duration_since(UNIX_EPOCH)
+        .unwrap()
+        .as_millis();
+    if binary {
+        return Response::Binary(binary_protocol::encode_report(
+            report,
+            timestamp as u64,
+            ServerTimes {
+                recv_ns,
+                send_ns: monotonic_nanos(),
+            },
+        ));
+    }
+    let side = match report.side {
+        Side::Buy => "BUY",
+        Side::Sell => "SELL",
+    };
+    let client_id = String::from_utf8_lossy(report.client_id.as_bytes());
+    let instrument_code = String::from_utf8_lossy(report.instrument.as_bytes());
+    let order_id = format_order_id(report.order_id);
+    let message = match report.kind {
+        ReportKind::Booked => json!({
+            "type": "BOOKED",
+            "order_book_sequence": report.sequence,
+            "side": side,
+            "uid": user_id,
+            "amount": report.amount.to_string(),
+            "price": report.price.to_string(),
+            "instrument_code": instrument_code,
+            "client_id": client_id,
+            "order_id": order_id,
+            "channel_name": "TRADING", // This is fixed for testing
+            "time": timestamp,
+            "recv_ns": recv_ns,
+            "send_ns": monotonic_nanos(),
+        }),
+        ReportKind::Fill => json!({
+            "type": "FILL",
+            "order_book_sequence": report.sequence,
+            "side": side,
+            "uid": user_id,
+            "amount": report.amount.to_string(),
+            "remaining": report.remaining.to_string(),
+            "price": report.price.to_string(),
+            "instrument_code": instrument_code,
+            "client_id": client_id,
+            "order_id": order_id,
+            "channel_name": "TRADING",
+            "time": timestamp,
+            "recv_ns": recv_ns,
+            "send_ns": monotonic_nanos(),
+        }),
+        ReportKind::Done(status) => json!({
+            "type": "DONE",
+            "status": match status {
+                Status::Cancelled => "CANCELLED",
+                Status::Filled => "FILLED",
+                Status::Rejected => "REJECTED",
+            },
+            "order_book_sequence": report.sequence,
+            "uid": user_id,
+            "instrument_code": instrument_code,
+            "client_id": client_id,
+            "order_id": order_id,
+            "channel_name": "TRADING",
+            "time": timestamp,
+            "recv_ns": recv_ns,
+            "send_ns": monotonic_nanos(),
+        }),
+    };
+    Response::Text(message.to_string())
+}
+
+/// Order ids are numbers, shown in the shape of the venue's UUIDs.
+pub fn format_order_id(order_id: u64) -> String {
+    format!("00000000-0000-4000-8000-{:012x}", order_id)
+}
@@ -0,0 +1,190 @@
+use std::io::{self, BufReader, BufWriter, Read, Write};
+use std::net::{TcpListener, TcpStream};
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::Duration;
+
+use crate::clock::monotonic_nanos;
+use crate::delay::{DelayProfile, Rng};
+use crate::exchange::Exchange;
+use crate::order_entry::{Response, Session};
+
+/// Length prefixed order entry over plain TCP: every message is a 4 byte big endian length followed by a JSON or a
+/// binary order entry message. JSON starts with '{', which no binary header does. Each connection is served by its
+/// own thread with blocking reads, so the responses of one read batch go out in one write. With a delay profile a
+/// second thread per connection writes each response when it's due, so reads never wait for a delay. Responses for
+/// resting orders that other sessions trade with are written by the thread of the session that traded.
+pub fn serve(
+    addr: (&str, u16),
+    max_message_length: usize,
+    exchange: Arc<Exchange>,
+    delay: Option<Arc<DelayProfile>>,
+) -> io::Result<()> {
+    let listener = TcpListener::bind(addr)?;
+    info!("Starting TCP listener on {}:{}", addr.0, addr.1);
+    thread::Builder::new()
+        .name("tcp-accept".to_string())
+        .spawn(move || {
+            for stream in listener.incoming() {
+                match stream {
+                    Ok(stream) => {
+                        let exchange = exchange.clone();
+                        let delay = delay.clone();
+                        let spawned = thread::Builder::new()
+                            .name("tcp-connection".to_string())
+                            .spawn(move || {
+                                if let Err(e) = handle_connection(stream, max_message_length, exchange, delay) {
+                                    debug!("TCP connection closed: {}", e);
+                                }
+                            });
+                        if let Err(e) = spawned {
+                            error!("Failed to spawn TCP connection thread: {}", e);
+                        }
+                    }
+                    Err(e) => error!("Failed to accept TCP connection: {}", e),
+                }
+            }
+        })?;
+    Ok(())
+}
+
+/// Where a connection's responses go.
+enum Responses {
+    Immediate(BufWriter<TcpStream>),
+    /// To the connection's writer thread with when they are due.
+    Delayed {
+        profile: Arc<DelayProfile>,
+        rng: Rng,
+        last_deadline: u64,
+        sender: Sender<(u64, Response)>,
+    },
+}
+
+impl Responses {
+    fn send(&mut self, response: Response, recv_ns: u64) -> io::Result<()> {
+        match self {
+            Self::Immediate(writer) => write_message(writer, &into_bytes(response)),
+            Self::Delayed {
+                profile,
+                rng,
+                last_deadline,
+                sender,
+            } => {
+                // never due before the response ahead of it, so responses keep the order of their requests
+                *last_deadline = (recv_ns + profile.sample(rng)).max(*last_deadline);
+                sender
+                    .send((*last_deadline, response))
+                    .map_err(|_| io::Error::new(io::ErrorKind::BrokenPipe, "TCP writer thread has stopped"))
+            }
+        }
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        match self {
+            Self::Immediate(writer) => writer.flush(),
+            Self::Delayed { .. } => Ok(()),
+        }
+    }
+}
+
+fn write_delayed(stream: TcpStream, responses: Receiver<(u64, Response)>) -> io::Result<()> {
+    let mut writer = BufWriter::new(stream);
+    while let Ok((deadline, mut response)) = responses.recv() {
+        let now = monotonic_nanos();
+        if deadline > now {
+            thread::sleep(Duration::from_nanos(deadline - now));
+        }
+        // the delay is time in the venue, so the response is stamped when it's sent rather than when it was built
+        response.stamp_send_ns(monotonic_nanos());
+        write_message(&mut writer, &into_bytes(response))?;
+        writer.flush()?;
+    }
+    Ok(())
+}
+
+fn handle_connection(
+    stream: TcpStream,
+    max_message_length: usize,
+    exchange: Arc<Exchange>,
+    delay: Option<Arc<DelayProfile>>,
+) -> io::Result<()> {
+    info!("TCP connection received from {}", stream.peer_addr()?);
+    stream.set_nodelay(true)?;
+    let mut reader = BufReader::new(stream.try_clone()?);
+    let writer = match delay {
+        Some(profile) => {
+            let (sender, receiver) = mpsc::channel();
+            thread::Builder::new()
+                .name("tcp-writer".to_string())
+                .spawn(move || {
+                    if let Err(e) = write_delayed(stream, receiver) {
+                        debug!("TCP connection closed: {}", e);
+                    }
+                })?;
+            Responses::Delayed {
+                profile,
+                rng: Rng::new(monotonic_nanos()),
+                last_deadline: 0,
+                sender,
+            }
+        }
+        None => Responses::Immediate(BufWriter::new(stream)),
+    };
+    let writer = Arc::new(Mutex::new(writer));
+    let mut session = Session::new(exchange);
+    let sink = writer.clone();
+    session.set_sink(Arc::new(move |response, recv_ns| {
+        let mut writer = sink.lock().unwrap();
+        // the connection's own thread may be blocked reading, so this one flushes
+        if let Err(e) = writer.send(response, recv_ns).and_then(|_| writer.flush()) {
+            debug!("Failed to write to TCP connection: {}", e);
+        }
+    }));
+    let mut message = Vec::new();
+    loop {
+        let mut length = [0u8; 4];
+        reader.read_exact(&mut length)?;
+        let length = u32::from_be_bytes(length) as usize;
+        if length > max_message_length {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                format!("message of {} bytes is over the limit of {}", length, max_message_length),
+            ));
+        }
+        message.resize(length, 0);
+        reader.read_exact(&mut message)?;
+        let recv_ns = monotonic_nanos();
+        let responses = if message.first() == Some(&b'{') {
+            match std::str::from_utf8(&message) {
+                Ok(text) => session.on_text(text, recv_ns),
+                Err(_) => {
+                    error!("Ignoring TCP message that is not UTF-8");
+                    Vec::new()
+                }
+            }
+        } else {
+            session.on_binary(&message, recv_ns)
+        };
+        let mut writer = writer.lock().unwrap();
+        for response in responses {
+            writer.send(response, recv_ns)?;
+        }
+        // flush once the client has nothing more buffered, like the Java client does per read batch
+        if reader.buffer().is_empty() {
+            writer.flush()?;
+        }
+    }
+}
+
+fn into_bytes(response: Response) -> Vec<u8> {
+    match response {
+        Response::Text(text) => text.into_bytes(),
+        Response::Binary(bin) => bin,
+    }
+}
+
+fn write_message(writer: &mut impl Write, message: &[u8]) -> io::Result<()> {
+    writer.write_all(&(message.len() as u32).to_be_bytes())?;
+    writer.write_all(message)
+}
@@ -1,126 +1,110 @@
+use std::collections::VecDeque;
+use std::sync::Arc;
+use std::time::Duration;
+
 use actix::prelude::*;
 use actix_web_actors::ws;
-use rand::Rng;
-use serde_json::{json, Value};
-use std::time::{SystemTime, UNIX_EPOCH};
-use uuid::Uuid;
 
-use crate::websocket_message_types::*;
+use crate::clock::monotonic_nanos;
+use crate::delay::{DelayProfile, Rng};
+use crate::exchange::Exchange;
+use crate::order_entry::{Response, Session};
+
+/// A response for a resting order of this connection, caused by another session's request.
+#[derive(Message)]
+#[rtype(result = "()")]
+struct Deliver(Response, u64);
 
 pub struct WebSocketActor {
-    user_id: Option<String>,
+    session: Session,
+    delay: Option<Arc<DelayProfile>>,
+    rng: Rng,
+    /// Responses held back by the delay profile with when they are due, in order. While there are any, one
+    /// `run_later` is pending for the first.
+    held: VecDeque<(u64, Response)>,
 }
 
 impl Actor for WebSocketActor {
     type Context = ws::WebsocketContext<Self>;
+
+    fn started(&mut self, ctx: &mut Self::Context) {
+        let address = ctx.address();
+        self.session
+            .set_sink(Arc::new(move |response, recv_ns| address.do_send(Deliver(response, recv_ns))));
+    }
+}
+
+impl Handler<Deliver> for WebSocketActor {
+    type Result = ();
+
+    fn handle(&mut self, Deliver(response, recv_ns): Deliver, ctx: &mut Self::Context) {
+        self.send(response, recv_ns, ctx);
+    }
 }
 
 impl WebSocketActor {
-    pub fn new() -> Self {
-        Self { user_id: None }
+    pub fn new(exchange: Arc<Exchange>, delay: Option<Arc<DelayProfile>>) -> Self {
+        Self {
+            session: Session::new(exchange),
+            delay,
+            rng: Rng::new(monotonic_nanos()),
+            held: VecDeque::new(),
+        }
+    }
+
+    fn send(&mut self, response: Response, recv_ns: u64, ctx: &mut ws::WebsocketContext<Self>) {
+        let Some(delay) = &self.delay else {
+            Self::write(response, ctx);
+            return;
+        };
+        // never due before the response ahead of it, so responses keep the order of their requests
+        let previous = self.held.back().map_or(0, |&(deadline, _)| deadline);
+        let deadline = (recv_ns + delay.sample(&mut self.rng)).max(previous);
+        self.held.push_back((deadline, response));
+        if self.held.len() == 1 {
+            self.schedule(ctx);
+        }
+    }
+
+    /// Has the reactor's timer wheel call back when the first held response is due, without blocking it meanwhile.
+    fn schedule(&mut self, ctx: &mut ws::WebsocketContext<Self>) {
+        if let Some(&(deadline, _)) = self.held.front() {
+            let wait = Duration::from_nanos(deadline.saturating_sub(monotonic_nanos()));
+            ctx.run_later(wait, |actor, ctx| actor.release(ctx));
+        }
+    }
+
+    fn release(&mut self, ctx: &mut ws::WebsocketContext<Self>) {
+        let now = monotonic_nanos();
+        while self.held.front().map_or(false, |&(deadline, _)| deadline <= now) {
+            let (_, mut response) = self.held.pop_front().unwrap();
+            // the delay is time in the venue, so the response is stamped when it's sent rather than when it was built
+            response.stamp_send_ns(now);
+            Self::write(response, ctx);
+        }
+        self.schedule(ctx);
+    }
+
+    fn write(response: Response, ctx: &mut ws::WebsocketContext<Self>) {
+        match response {
+            Response::Text(text) => ctx.text(text),
+            Response::Binary(bin) => ctx.binary(bin),
+        }
     }
 }
 
 impl StreamHandler<Result<ws::Message, ws::ProtocolError>> for WebSocketActor {
     fn handle(&mut self, msg: Result<ws::Message, ws::ProtocolError>, ctx: &mut Self::Context) {
+        let recv_ns = monotonic_nanos();
         match msg {
             Ok(ws::Message::Text(text)) => {
-                debug!("Received message: {}", text);
-                let Ok(payload): Result<Value, _> = serde_json::from_str(&text) else {
-                    error!("Payload is invalid JSON: {}", text);
-                    return;
-                };
-                let Some(payload_type) = payload["type"].as_str() else {
-                    error!("Payload does not have a 'type' field: {}", payload);
-                    return;
-                };
-
-                match payload_type {
-                    "AUTHENTICATE" => {
-                        let auth_request: AuthRequest = serde_json::from_str(&text).unwrap();
-                        self.user_id = Some(auth_request.api_token);
-
-                        ctx.text(json!({"type": "AUTHENTICATED"}).to_string());
-                    }
-                    "SUBSCRIBE" => {
-                        let timestamp = SystemTime::now()
-                            .duration_since(UNIX_EPOCH)
-                            .unwrap()
-                            .as_millis();
-                        let subscription_request: SubscriptionRequest =
-                            serde_json::from_str(&text).unwrap();
-
-                        let output_channels = subscription_request
-                            .channels
-                            .iter()
-                            .map(|channel| {
-                                json!({
-                                    "account_id": self.user_id.as_ref().unwrap(),
-                                    "name": channel.name
-                                })
-                            })
-                            .collect::<Vec<Value>>();
-
-                        ctx.text(
-                            json!({
-                                "type": "SUBSCRIPTIONS",
-                                "channels": output_channels,
-                                "time": timestamp,
-                            })
-                            .to_string(),
-                        );
-                    }
-                    "CREATE_ORDER" => {
-                        let timestamp = SystemTime::now()
-                            .duration_since(UNIX_EPOCH)
-                            .unwrap()
-                            .as_millis();
-                        let limit_order_request: LimitOrderRequest =
-                            serde_json::from_str(&text).unwrap();
-                        let mut rng = rand::thread_rng();
-                        ctx.text(
-                            json!({
-                                "type": "BOOKED",
-                                "order_book_sequence": rng.gen::<i64>(),
-                                "side": limit_order_request.order.side,
-                                "uid": self.user_id.as_ref().unwrap(),
-                                "amount": limit_order_request.order.amount,
-                                "price": limit_order_request.order.price,
-                                "instrument_code": limit_order_request.order.instrument_code,
-                                "client_id": limit_order_request.order.client_id,
-                                "order_id": Uuid::new_v4().to_string(),
-                                "channel_name": "TRADING", // This is fixed for testing
-                                "time": timestamp,
-                            })
-                            .to_string(),
-                        );
-                    }
-                    "CANCEL_ORDER" => {
-                        let timestamp = SystemTime::now()
-                            .duration_since(UNIX_EPOCH)
-                            .unwrap()
-                            .as_millis();
-                        let cancel_order_request: CancelOrderRequest =
-                            serde_json::from_str(&text).unwrap();
-                        let mut rng = rand::thread_rng();
-                        ctx.text(
-                            json!({
-                                "type": "DONE",
-                                "status": "CANCELLED",
-                                "order_book_sequence": rng.gen::<i64>(),
-                                "uid": self.user_id.as_ref().unwrap(),
-                                "instrument_code": cancel_order_request.instrument_code,
-                                "client_id": cancel_order_request.client_id,
-                                "order_id": Uuid::new_v4().to_string(),
-                                "channel_name": "TRADING", // This is fixed for testing
-                                "time": timestamp,
-                            })
-                            .to_string(),
-                        );
-                    }
-                    _ => {
-                        error!("Ignoring unknown message type: {}", payload);
-                    }
+                for response in self.session.on_text(&text, recv_ns) {
+                    self.send(response, recv_ns, ctx);
+                }
+            }
+            Ok(ws::Message::Binary(bin)) => {
+                for response in self.session.on_binary(&bin, recv_ns) {
+                    self.send(response, recv_ns, ctx);
                 }
             }
             Ok(ws::Message::Close(reason)) => {
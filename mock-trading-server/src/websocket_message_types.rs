@@ -22,10 +22,12 @@ pub struct Order {
     pub instrument_code: String,
     pub client_id: String,
     pub side: String,
-    // r#type: String,
-    pub price: String, // These are String becasue we only need to do ping-pong, no need to parse it to number
+    #[serde(default)]
+    pub r#type: String,
+    pub price: String, // Integers in strings, as the venue sends them; anything else is rejected
     pub amount: String,
-    // time_in_force: String,
+    #[serde(default)]
+    pub time_in_force: String,
 }
 
 #[derive(Deserialize)]
@@ -0,0 +1,189 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+/**
+ * Decimal conversions between longs and ASCII bytes in a ByteBuf, without going through String. Prices and amounts are
+ * fixed-point: a long counting units of the instrument's last decimal place, e.g. 12345 at scale 2 is "123.45".
+ * Digits are written two at a time from a table of all 100 digit pairs, so a number takes half the divisions.
+ */
+public final class AsciiNumbers {
+    /**
+     * Returned by the parse methods when the bytes are not a decimal number that fits in a long.
+     */
+    public static final long INVALID = Long.MIN_VALUE;
+    /**
+     * Largest number of decimal places a scale can have; 10^18 is the largest power of ten a long holds.
+     */
+    public static final int MAX_SCALE = 18;
+    private static final long[] POWERS_OF_TEN = new long[MAX_SCALE + 1];
+    /**
+     * The two ASCII digits of 0 to 99, big endian so that one setShort writes them in order.
+     */
+    private static final short[] DIGIT_PAIRS = new short[100];
+
+    static {
+        POWERS_OF_TEN[0] = 1;
+        for (int i = 1; i <= MAX_SCALE; i++) {
+            POWERS_OF_TEN[i] = POWERS_OF_TEN[i - 1] * 10;
+        }
+        for (int i = 0; i < DIGIT_PAIRS.length; i++) {
+            DIGIT_PAIRS[i] = (short) (('0' + i / 10) << 8 | ('0' + i % 10));
+        }
+    }
+
+    private AsciiNumbers() {
+    }
+
+    /**
+     * @return number of ASCII characters {@link #writeLong(ByteBuf, long)} writes for the value
+     */
+    public static int digitCount(long value) {
+        if (value < 0) {
+            return value == Long.MIN_VALUE ? 20 : 1 + digitCount(-value);
+        }
+        int count = 1;
+        long threshold = 10;
+        while (count < 19 && value >= threshold) {
+            count++;
+            threshold *= 10;
+        }
+        return count;
+    }
+
+    /**
+     * Writes the decimal form of the value at the writer index and advances it.
+     */
+    public static void writeLong(ByteBuf out, long value) {
+        writeDecimal(out, value, 0);
+    }
+
+    /**
+     * @return number of ASCII characters {@link #writeDecimal(ByteBuf, long, int)} writes for the value
+     */
+    public static int decimalLength(long scaled, int scale) {
+        if (scale == 0) {
+            return digitCount(scaled);
+        }
+        final int sign = scaled < 0 ? 1 : 0;
+        // at least one integer digit, then the point and all the decimal places
+        return sign + Math.max(digitCount(scaled) - sign, scale + 1) + 1;
+    }
+
+    /**
+     * Writes a fixed-point value with exactly {@code scale} decimal places at the writer index and advances it, e.g.
+     * 5 at scale 3 as "0.005". Scale 0 writes a plain integer.
+     */
+    public static void writeDecimal(ByteBuf out, long scaled, int scale) {
+        if (scale < 0 || scale > MAX_SCALE) {
+            throw new IllegalArgumentException("scale out of range: " + scale);
+        }
+        final int length = decimalLength(scaled, scale);
+        out.ensureWritable(length);
+        final int start = out.writerIndex();
+        int index = start + length;
+        // work on the negative value so that Long.MIN_VALUE does not overflow
+        long rest = scaled < 0 ? scaled : -scaled;
+        if (scale > 0) {
+            int places = scale;
+            for (; places >= 2; places -= 2) {
+                index -= 2;
+                out.setShort(index, DIGIT_PAIRS[(int) -(rest % 100)]);
+                rest /= 100;
+            }
+            if (places == 1) {
+                out.setByte(--index, '0' - (int) (rest % 10));
+                rest /= 10;
+            }
+            out.setByte(--index, '.');
+        }
+        while (rest <= -100) {
+            index -= 2;
+            out.setShort(index, DIGIT_PAIRS[(int) -(rest % 100)]);
+            rest /= 100;
+        }
+        if (rest <= -10) {
+            index -= 2;
+            out.setShort(index, DIGIT_PAIRS[(int) -rest]);
+        } else {
+            out.setByte(--index, '0' - (int) rest);
+        }
+        if (scaled < 0) {
+            out.setByte(--index, '-');
+        }
+        out.writerIndex(start + length);
+    }
+
+    /**
+     * Parses an unsigned decimal number.
+     *
+     * @return the value, or {@link #INVALID} if the view is empty, contains a non digit or overflows
+     */
+    public static long parseLong(AsciiView view) {
+        final int length = view.length();
+        if (length == 0 || length > 19) {
+            return INVALID;
+        }
+        long value = 0;
+        for (int i = 0; i < length; i++) {
+            final int digit = view.byteAt(i) - '0';
+            if (digit < 0 || digit > 9) {
+                return INVALID;
+            }
+            value = value * 10 + digit;
+        }
+        return value < 0 ? INVALID : value;
+    }
+
+    /**
+     * Parses an unsigned decimal number with up to {@code scale} decimal places into units of the last one, e.g. "1.5"
+     * at scale 2 as 150.
+     *
+     * @return the scaled value, or {@link #INVALID} if the view isn't such a number, has more decimal places than the
+     * scale or overflows
+     */
+    public static long parseDecimal(AsciiView view, int scale) {
+        if (scale < 0 || scale > MAX_SCALE) {
+            throw new IllegalArgumentException("scale out of range: " + scale);
+        }
+        final int length = view.length();
+        long value = 0;
+        int digits = 0;
+        int places = -1;
+        for (int i = 0; i < length; i++) {
+            final byte b = view.byteAt(i);
+            if (b == '.' && places < 0) {
+                places = 0;
+                continue;
+            }
+            final int digit = b - '0';
+            if (digit < 0 || digit > 9 || (places >= 0 && ++places > scale) || value > (Long.MAX_VALUE - digit) / 10) {
+                return INVALID;
+            }
+            value = value * 10 + digit;
+            digits++;
+        }
+        if (digits == 0) {
+            return INVALID;
+        }
+        final long multiplier = POWERS_OF_TEN[scale - Math.max(places, 0)];
+        return value > Long.MAX_VALUE / multiplier ? INVALID : value * multiplier;
+    }
+}
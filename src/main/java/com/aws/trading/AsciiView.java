@@ -0,0 +1,103 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Reusable flyweight over a range of ASCII bytes inside a ByteBuf. It never copies the bytes, so it is only valid
+ * until the underlying buffer is released or rewritten.
+ */
+public final class AsciiView implements CharSequence {
+    private ByteBuf buffer;
+    private int offset;
+    private int length;
+
+    public AsciiView wrap(ByteBuf buffer, int offset, int length) {
+        this.buffer = buffer;
+        this.offset = offset;
+        this.length = length;
+        return this;
+    }
+
+    public void reset() {
+        this.buffer = null;
+        this.offset = 0;
+        this.length = 0;
+    }
+
+    public boolean isPresent() {
+        return buffer != null;
+    }
+
+    public ByteBuf buffer() {
+        return buffer;
+    }
+
+    public int offset() {
+        return offset;
+    }
+
+    @Override
+    public int length() {
+        return length;
+    }
+
+    public byte byteAt(int index) {
+        return buffer.getByte(offset + index);
+    }
+
+    @Override
+    public char charAt(int index) {
+        return (char) (byteAt(index) & 0xFF);
+    }
+
+    public boolean contentEquals(byte[] bytes) {
+        if (buffer == null || bytes.length != length) {
+            return false;
+        }
+        for (int i = 0; i < length; i++) {
+            if (buffer.getByte(offset + i) != bytes[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Copies the viewed bytes to the end of the destination buffer.
+     */
+    public void copyTo(ByteBuf destination) {
+        destination.writeBytes(buffer, offset, length);
+    }
+
+    @Override
+    public CharSequence subSequence(int start, int end) {
+        return new AsciiView().wrap(buffer, offset + start, end - start);
+    }
+
+    /**
+     * Allocates a String, only meant for logging and error paths.
+     */
+    @Override
+    public String toString() {
+        return buffer == null ? "" : buffer.toString(offset, length, StandardCharsets.US_ASCII);
+    }
+}
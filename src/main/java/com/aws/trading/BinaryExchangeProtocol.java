@@ -0,0 +1,179 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.ByteBufAllocator;
+import io.netty.buffer.PooledByteBufAllocator;
+import io.netty.handler.codec.http.websocketx.BinaryWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
+
+import java.nio.charset.StandardCharsets;
+import java.util.Collection;
+import java.util.HashMap;
+import java.util.List;
+
+import static com.aws.trading.BinarySchema.*;
+
+/**
+ * Binary order entry, see {@link BinarySchema}. Like {@link TemplateExchangeProtocol} every message is pre-rendered
+ * per instrument, order type and side, so encoding is one memcpy of the template followed by patching the client order id, price
+ * and amount in place. Messages are sent as binary frames.
+ * <p>
+ * The String based methods predate numeric client ids and are not supported.
+ */
+public class BinaryExchangeProtocol implements ExchangeProtocol {
+    private final ByteBufAllocator allocator;
+    private final HashMap<String, Templates> templates = new HashMap<>();
+
+    public BinaryExchangeProtocol() {
+        this(PooledByteBufAllocator.DEFAULT, List.of());
+    }
+
+    /**
+     * @param pairs instruments rendered up front, any other pair gets its templates on first use
+     */
+    public BinaryExchangeProtocol(ByteBufAllocator allocator, Collection<String> pairs) {
+        this.allocator = allocator;
+        pairs.forEach(this::templatesFor);
+    }
+
+    private static final class Templates {
+        /**
+         * Indexed by {@link OrderType} and then {@link Side} ordinal.
+         */
+        final ByteBuf[][] orders;
+        final ByteBuf cancel;
+
+        Templates(ByteBuf[][] orders, ByteBuf cancel) {
+            this.orders = orders;
+            this.cancel = cancel;
+        }
+
+        ByteBuf order(OrderType type, Side side) {
+            return orders[type.ordinal()][side.ordinal()];
+        }
+    }
+
+    private Templates templatesFor(String pair) {
+        return templates.computeIfAbsent(pair, p -> {
+            final byte[] instrument = p.getBytes(StandardCharsets.US_ASCII);
+            if (instrument.length > INSTRUMENT_LENGTH) {
+                throw new IllegalArgumentException("instrument " + p + " is longer than " + INSTRUMENT_LENGTH + " bytes");
+            }
+            final ByteBuf[][] orders = new ByteBuf[OrderType.values().length][Side.values().length];
+            for (OrderType type : OrderType.values()) {
+                orders[type.ordinal()][Side.BUY.ordinal()] = renderOrder(instrument, type, SIDE_BUY);
+                orders[type.ordinal()][Side.SELL.ordinal()] = renderOrder(instrument, type, SIDE_SELL);
+            }
+            return new Templates(orders, renderCancel(instrument));
+        });
+    }
+
+    private ByteBuf renderOrder(byte[] instrument, OrderType type, byte side) {
+        final ByteBuf buf = renderHeader(CREATE_ORDER_TEMPLATE, CREATE_ORDER_BLOCK_LENGTH);
+        buf.setByte(HEADER_LENGTH + CREATE_ORDER_SIDE, side);
+        buf.setByte(HEADER_LENGTH + CREATE_ORDER_TYPE, type.binaryType);
+        buf.setByte(HEADER_LENGTH + CREATE_ORDER_TIME_IN_FORCE, type.binaryTimeInForce);
+        buf.setBytes(HEADER_LENGTH + CREATE_ORDER_INSTRUMENT, instrument);
+        return buf;
+    }
+
+    private ByteBuf renderCancel(byte[] instrument) {
+        final ByteBuf buf = renderHeader(CANCEL_ORDER_TEMPLATE, CANCEL_ORDER_BLOCK_LENGTH);
+        buf.setBytes(HEADER_LENGTH + CANCEL_ORDER_INSTRUMENT, instrument);
+        return buf;
+    }
+
+    private ByteBuf renderHeader(int templateId, int blockLength) {
+        final int length = HEADER_LENGTH + blockLength;
+        final ByteBuf buf = allocator.directBuffer(length, length).writeZero(length);
+        buf.setShortLE(BLOCK_LENGTH_OFFSET, blockLength);
+        buf.setShortLE(TEMPLATE_ID_OFFSET, templateId);
+        buf.setShortLE(SCHEMA_ID_OFFSET, SCHEMA_ID);
+        buf.setShortLE(VERSION_OFFSET, VERSION);
+        return buf;
+    }
+
+    private ByteBuf copyOf(ByteBuf template) {
+        final int length = template.readableBytes();
+        return allocator.directBuffer(length).writeBytes(template, template.readerIndex(), length);
+    }
+
+    @Override
+    public BinaryWebSocketFrame createOrder(String pair, OrderType type, Side side, ClientIdGenerator clientIds, long clientOrderId, long price, long amount) {
+        final ByteBuf buf = copyOf(templatesFor(pair).order(type, side));
+        buf.setLongLE(HEADER_LENGTH + CREATE_ORDER_CLIENT_ORDER_ID, clientOrderId);
+        buf.setLongLE(HEADER_LENGTH + CREATE_ORDER_PRICE, price);
+        buf.setLongLE(HEADER_LENGTH + CREATE_ORDER_AMOUNT, amount);
+        return new BinaryWebSocketFrame(buf);
+    }
+
+    @Override
+    public BinaryWebSocketFrame createBuyOrder(String pair, ClientIdGenerator clientIds, long clientOrderId) {
+        return createOrder(pair, OrderType.LIMIT, Side.BUY, clientIds, clientOrderId,
+                TemplateExchangeProtocol.DEFAULT_PRICE, TemplateExchangeProtocol.DEFAULT_AMOUNT);
+    }
+
+    /**
+     * Echoes the 8 byte client order id of a {@link BinaryResponseDecoder} verbatim.
+     */
+    @Override
+    public BinaryWebSocketFrame createCancelOrder(String pair, AsciiView clientId) {
+        if (clientId.length() != CLIENT_ORDER_ID_LENGTH) {
+            throw new IllegalArgumentException("binary client order ids are " + CLIENT_ORDER_ID_LENGTH + " bytes");
+        }
+        final ByteBuf buf = copyOf(templatesFor(pair).cancel);
+        buf.setBytes(HEADER_LENGTH + CANCEL_ORDER_CLIENT_ORDER_ID, clientId.buffer(), clientId.offset(), CLIENT_ORDER_ID_LENGTH);
+        return new BinaryWebSocketFrame(buf);
+    }
+
+    @Override
+    public ResponseDecoder newResponseDecoder() {
+        return new BinaryResponseDecoder();
+    }
+
+    @Override
+    public boolean isBinary() {
+        return true;
+    }
+
+    @Override
+    public TextWebSocketFrame createBuyOrder(String pair, String clientId) {
+        throw unsupported();
+    }
+
+    @Override
+    public ByteBuf createSellOrder(String pair, String clientId) {
+        throw unsupported();
+    }
+
+    @Override
+    public ByteBuf createOrder(String pair, String type, String uuid, String side, String price, String qty) {
+        throw unsupported();
+    }
+
+    @Override
+    public TextWebSocketFrame createCancelOrder(String pair, String clientid) {
+        throw unsupported();
+    }
+
+    private static UnsupportedOperationException unsupported() {
+        return new UnsupportedOperationException("binary order entry needs numeric client order ids, use the ClientIdGenerator methods");
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+import static com.aws.trading.BinarySchema.*;
+
+/**
+ * Flyweight over a binary BOOKED, FILL or DONE message, see {@link BinarySchema}. Parsing only checks the header; fields are
+ * read straight from the buffer when asked for.
+ */
+public final class BinaryResponseDecoder implements ResponseDecoder {
+    private static final int NO_FIELD = -1;
+    private final AsciiView clientId = new AsciiView();
+    private final AsciiView instrumentCode = new AsciiView();
+    private ByteBuf buffer;
+    private int block;
+    private int recvNs;
+    private int sendNs;
+    private int price;
+    private MessageType messageType = MessageType.UNKNOWN;
+
+    @Override
+    public boolean parse(ByteBuf buf) {
+        clientId.reset();
+        instrumentCode.reset();
+        messageType = MessageType.UNKNOWN;
+        final int offset = buf.readerIndex();
+        if (buf.readableBytes() < HEADER_LENGTH || buf.getUnsignedShortLE(offset + SCHEMA_ID_OFFSET) != SCHEMA_ID) {
+            return false;
+        }
+        final int blockLength = buf.getUnsignedShortLE(offset + BLOCK_LENGTH_OFFSET);
+        final int instrumentOffset;
+        switch (buf.getUnsignedShortLE(offset + TEMPLATE_ID_OFFSET)) {
+            case BOOKED_TEMPLATE:
+                if (blockLength < BOOKED_BLOCK_LENGTH) {
+                    return false;
+                }
+                messageType = MessageType.BOOKED;
+                instrumentOffset = BOOKED_INSTRUMENT;
+                recvNs = BOOKED_RECV_NS;
+                sendNs = BOOKED_SEND_NS;
+                price = BOOKED_PRICE;
+                break;
+            case DONE_TEMPLATE:
+                if (blockLength < DONE_BLOCK_LENGTH) {
+                    return false;
+                }
+                messageType = MessageType.DONE;
+                instrumentOffset = DONE_INSTRUMENT;
+                recvNs = DONE_RECV_NS;
+                sendNs = DONE_SEND_NS;
+                price = NO_FIELD;
+                break;
+            case FILL_TEMPLATE:
+                if (blockLength < FILL_BLOCK_LENGTH) {
+                    return false;
+                }
+                messageType = MessageType.FILL;
+                instrumentOffset = FILL_INSTRUMENT;
+                recvNs = FILL_RECV_NS;
+                sendNs = FILL_SEND_NS;
+                price = FILL_PRICE;
+                break;
+            default:
+                return true;
+        }
+        if (buf.readableBytes() < HEADER_LENGTH + blockLength) {
+            messageType = MessageType.UNKNOWN;
+            return false;
+        }
+        this.buffer = buf;
+        this.block = offset + HEADER_LENGTH;
+        // client order id is the first field of every response
+        clientId.wrap(buf, block, CLIENT_ORDER_ID_LENGTH);
+        final int instrument = block + instrumentOffset;
+        int length = 0;
+        while (length < INSTRUMENT_LENGTH && buf.getByte(instrument + length) != 0) {
+            length++;
+        }
+        instrumentCode.wrap(buf, instrument, length);
+        return true;
+    }
+
+    @Override
+    public MessageType messageType() {
+        return messageType;
+    }
+
+    @Override
+    public AsciiView clientId() {
+        return clientId;
+    }
+
+    @Override
+    public AsciiView instrumentCode() {
+        return instrumentCode;
+    }
+
+    @Override
+    public OrderStatus status() {
+        return messageType == MessageType.DONE ? OrderStatus.of(buffer.getByte(block + DONE_STATUS)) : OrderStatus.UNKNOWN;
+    }
+
+    @Override
+    public long clientOrderId(ClientIdGenerator clientIds) {
+        return clientId.isPresent() ? buffer.getLongLE(block) : InFlightOrderTable.MISSING;
+    }
+
+    @Override
+    public long serverReceiveNanos() {
+        return clientId.isPresent() ? buffer.getLongLE(block + recvNs) : NO_TIMESTAMP;
+    }
+
+    @Override
+    public long serverSendNanos() {
+        return clientId.isPresent() ? buffer.getLongLE(block + sendNs) : NO_TIMESTAMP;
+    }
+
+    /**
+     * Binary prices are scaled longs already, so the scale is not applied.
+     */
+    @Override
+    public long price(int scale) {
+        return clientId.isPresent() && price != NO_FIELD ? buffer.getLongLE(block + price) : NO_VALUE;
+    }
+}
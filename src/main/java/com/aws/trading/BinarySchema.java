@@ -0,0 +1,117 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+/**
+ * Fixed layout of the binary order entry messages, shared with the mock server's binary_protocol module. Every
+ * message is an SBE style 8 byte header followed by a fixed block; all integers are little endian and instrument
+ * codes are ASCII padded with NUL bytes. Offsets in a block are relative to the end of the header.
+ *
+ * <pre>
+ * header        block_length u16 | template_id u16 | schema_id u16 | version u16
+ * CREATE_ORDER  client_order_id u64 | price i64 | amount i64 | side u8 | type u8 | time_in_force u8 | pad u8
+ *               | instrument [16]
+ * CANCEL_ORDER  client_order_id u64 | instrument [16]
+ * BOOKED        client_order_id u64 | order_id u64 | order_book_sequence i64 | price i64 | amount i64 | time u64
+ *               | side u8 | pad [7] | instrument [16] | recv_ns u64 | send_ns u64
+ * DONE          client_order_id u64 | order_id u64 | order_book_sequence i64 | time u64 | status u8 | pad [7]
+ *               | instrument [16] | recv_ns u64 | send_ns u64
+ * FILL          client_order_id u64 | order_id u64 | order_book_sequence i64 | price i64 | amount i64
+ *               | remaining i64 | time u64 | side u8 | pad [7] | instrument [16] | recv_ns u64 | send_ns u64
+ * </pre>
+ */
+public final class BinarySchema {
+    public static final int SCHEMA_ID = 1;
+    public static final int VERSION = 1;
+
+    public static final int HEADER_LENGTH = 8;
+    public static final int BLOCK_LENGTH_OFFSET = 0;
+    public static final int TEMPLATE_ID_OFFSET = 2;
+    public static final int SCHEMA_ID_OFFSET = 4;
+    public static final int VERSION_OFFSET = 6;
+
+    public static final int CREATE_ORDER_TEMPLATE = 1;
+    public static final int CANCEL_ORDER_TEMPLATE = 2;
+    public static final int BOOKED_TEMPLATE = 3;
+    public static final int DONE_TEMPLATE = 4;
+    public static final int FILL_TEMPLATE = 5;
+
+    public static final int INSTRUMENT_LENGTH = 16;
+    public static final int CLIENT_ORDER_ID_LENGTH = 8;
+
+    public static final int CREATE_ORDER_CLIENT_ORDER_ID = 0;
+    public static final int CREATE_ORDER_PRICE = 8;
+    public static final int CREATE_ORDER_AMOUNT = 16;
+    public static final int CREATE_ORDER_SIDE = 24;
+    public static final int CREATE_ORDER_TYPE = 25;
+    public static final int CREATE_ORDER_TIME_IN_FORCE = 26;
+    public static final int CREATE_ORDER_INSTRUMENT = 28;
+    public static final int CREATE_ORDER_BLOCK_LENGTH = 44;
+
+    public static final int CANCEL_ORDER_CLIENT_ORDER_ID = 0;
+    public static final int CANCEL_ORDER_INSTRUMENT = 8;
+    public static final int CANCEL_ORDER_BLOCK_LENGTH = 24;
+
+    public static final int BOOKED_CLIENT_ORDER_ID = 0;
+    public static final int BOOKED_ORDER_ID = 8;
+    public static final int BOOKED_ORDER_BOOK_SEQUENCE = 16;
+    public static final int BOOKED_PRICE = 24;
+    public static final int BOOKED_AMOUNT = 32;
+    public static final int BOOKED_TIME = 40;
+    public static final int BOOKED_SIDE = 48;
+    public static final int BOOKED_INSTRUMENT = 56;
+    public static final int BOOKED_RECV_NS = 72;
+    public static final int BOOKED_SEND_NS = 80;
+    public static final int BOOKED_BLOCK_LENGTH = 88;
+
+    public static final int DONE_CLIENT_ORDER_ID = 0;
+    public static final int DONE_ORDER_ID = 8;
+    public static final int DONE_ORDER_BOOK_SEQUENCE = 16;
+    public static final int DONE_TIME = 24;
+    public static final int DONE_STATUS = 32;
+    public static final int DONE_INSTRUMENT = 40;
+    public static final int DONE_RECV_NS = 56;
+    public static final int DONE_SEND_NS = 64;
+    public static final int DONE_BLOCK_LENGTH = 72;
+
+    public static final int FILL_CLIENT_ORDER_ID = 0;
+    public static final int FILL_ORDER_ID = 8;
+    public static final int FILL_ORDER_BOOK_SEQUENCE = 16;
+    public static final int FILL_PRICE = 24;
+    public static final int FILL_AMOUNT = 32;
+    public static final int FILL_REMAINING = 40;
+    public static final int FILL_TIME = 48;
+    public static final int FILL_SIDE = 56;
+    public static final int FILL_INSTRUMENT = 64;
+    public static final int FILL_RECV_NS = 80;
+    public static final int FILL_SEND_NS = 88;
+    public static final int FILL_BLOCK_LENGTH = 96;
+
+    public static final byte SIDE_BUY = 0;
+    public static final byte SIDE_SELL = 1;
+    public static final byte ORDER_TYPE_LIMIT = 0;
+    public static final byte ORDER_TYPE_MARKET = 1;
+    public static final byte TIME_IN_FORCE_GOOD_TILL_CANCELLED = 0;
+    public static final byte TIME_IN_FORCE_IMMEDIATE_OR_CANCELLED = 1;
+    public static final byte STATUS_CANCELLED = 0;
+    public static final byte STATUS_FILLED = 1;
+    public static final byte STATUS_REJECTED = 2;
+
+    private BinarySchema() {
+    }
+}
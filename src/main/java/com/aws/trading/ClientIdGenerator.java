@@ -0,0 +1,71 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+/**
+ * Produces client order ids for one connection. Every id has a numeric key used by the {@link InFlightOrderTable}s,
+ * its ASCII form is written straight into the outbound buffer, and the key is recovered from the client id echoed in
+ * a response.
+ */
+public interface ClientIdGenerator {
+    enum Mode {
+        /**
+         * Random UUIDs, for exchanges that require them.
+         */
+        UUID,
+        /**
+         * Per-connection prefix followed by a monotonic counter, written as decimal digits.
+         */
+        SEQUENTIAL
+    }
+
+    static ClientIdGenerator create(Mode mode, int connectionPrefix) {
+        switch (mode) {
+            case UUID:
+                return new UuidClientIdGenerator();
+            case SEQUENTIAL:
+                return new SequentialClientIdGenerator(connectionPrefix);
+            default:
+                throw new IllegalArgumentException("unsupported client id mode " + mode);
+        }
+    }
+
+    /**
+     * Advances to a new id.
+     *
+     * @return the numeric key of the new id
+     */
+    long next();
+
+    /**
+     * @return number of ASCII bytes {@link #write(ByteBuf, long)} produces for the key
+     */
+    int length(long clientOrderId);
+
+    /**
+     * Writes the ASCII client id of the key at the writer index of the buffer.
+     */
+    void write(ByteBuf out, long clientOrderId);
+
+    /**
+     * @return the key of the client id, or {@link InFlightOrderTable#MISSING} if it was not produced by this mode
+     */
+    long parse(AsciiView clientId);
+}
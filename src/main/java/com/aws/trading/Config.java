@@ -17,6 +17,7 @@
  */
 package com.aws.trading;
 
+import io.netty.channel.epoll.EpollMode;
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
@@ -28,6 +29,7 @@ import java.util.Arrays;
 import java.util.List;
 import java.util.Properties;
 import java.util.stream.Collectors;
+import java.util.stream.IntStream;
 
 public class Config {
     private static final Logger LOGGER = LogManager.getLogger(Config.class);
@@ -38,10 +40,46 @@ public class Config {
     public static final int HTTP_PORT;
 
     public static final int WEBSOCKET_PORT;
+    public static final Framing FRAMING;
+    public static final int TCP_PORT;
     public static final int TEST_SIZE;
     public static final long WARMUP_COUNT;
     public static final boolean USE_IOURING;
+    public static final Transport TRANSPORT;
+    public static final EpollMode EPOLL_MODE;
+    public static final boolean EPOLL_BUSY_WAIT;
+    public static final int SO_BUSY_POLL_MICROS;
+    public static final int IOURING_RING_SIZE;
+    public static final int IOURING_ASYNC_THRESHOLD;
+    public static final boolean BUSY_SPIN;
+    public static final long SPIN_ITERATIONS;
+    public static final long YIELD_ITERATIONS;
+    public static final long PARK_NANOS;
+    public static final int[] NETTY_IO_CPUS;
+    public static final int[] NETTY_WORKER_CPUS;
+    public static final EventLoopLayout EVENT_LOOP_LAYOUT;
+    public static final int[] CONNECTION_LOOPS;
+    public static final long AGGREGATION_INTERVAL_MS;
+    public static final WebSocketCodec WEBSOCKET_CODEC;
+    public static final boolean WS_DEFLATE;
+    public static final boolean WS_DEFLATE_OUTBOUND;
+    public static final int WS_DEFLATE_MIN_SIZE;
+    public static final int WS_DEFLATE_LEVEL;
+    public static final boolean WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER;
+    public static final boolean WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER;
     public static final int EXCHANGE_CLIENT_COUNT;
+    public static final int IN_FLIGHT_TABLE_CAPACITY;
+    public static final ClientIdGenerator.Mode CLIENT_ID_MODE;
+    public static final ExchangeProtocol.Encoding PROTOCOL_ENCODING;
+    public static final LoadMode LOAD_MODE;
+    public static final long TARGET_RATE_PER_CONNECTION;
+    public static final String REPLAY_FILE;
+    public static final String SCENARIO_FILE;
+    public static final DecimalScales DECIMAL_SCALES;
+    public static final int IN_FLIGHT_WINDOW;
+    public static final long CROSSING_ORDER_INTERVAL;
+    public static final long CROSSING_ORDER_AMOUNT;
+    public static final KernelTimestamping.Mode KERNEL_TIMESTAMPING;
 
     static {
         URL resource = Config.class.getClassLoader().getResource("config.properties");
@@ -62,11 +100,48 @@ public class Config {
         HOST = getProperty("HOST", "localhost");
         HTTP_PORT = getIntegerProperty("HTTP_PORT", "8888");
         WEBSOCKET_PORT = getIntegerProperty("WEBSOCKET_PORT", "8888");
+        FRAMING = Framing.valueOf(getProperty("FRAMING", "WEBSOCKET").toUpperCase());
+        TCP_PORT = getIntegerProperty("TCP_PORT", "8889");
         API_TOKEN = getIntegerProperty("API_TOKEN", "3002");
         TEST_SIZE = getIntegerProperty("TEST_SIZE", "1000");
         USE_IOURING = getBooleanProperty("USE_IOURING", "false");
+        TRANSPORT = Transport.valueOf(getProperty("TRANSPORT", USE_IOURING ? "IO_URING" : "NIO").toUpperCase());
+        EPOLL_MODE = EpollMode.valueOf(getProperty("EPOLL_MODE", "EDGE_TRIGGERED").toUpperCase());
+        EPOLL_BUSY_WAIT = getBooleanProperty("EPOLL_BUSY_WAIT", "false");
+        SO_BUSY_POLL_MICROS = getIntegerProperty("SO_BUSY_POLL_MICROS", "0");
+        IOURING_RING_SIZE = getIntegerProperty("IOURING_RING_SIZE", "4096");
+        IOURING_ASYNC_THRESHOLD = getIntegerProperty("IOURING_ASYNC_THRESHOLD", "25");
+        BUSY_SPIN = getBooleanProperty("BUSY_SPIN", "false");
+        SPIN_ITERATIONS = getLongProperty("SPIN_ITERATIONS", "1000000");
+        YIELD_ITERATIONS = getLongProperty("YIELD_ITERATIONS", "1000");
+        PARK_NANOS = getLongProperty("PARK_NANOS", "50000");
+        NETTY_IO_CPUS = getCpuListProperty("NETTY_IO_CPUS", "");
+        NETTY_WORKER_CPUS = getCpuListProperty("NETTY_WORKER_CPUS", "");
+        EVENT_LOOP_LAYOUT = EventLoopLayout.valueOf(getProperty("EVENT_LOOP_LAYOUT", "SPLIT").toUpperCase());
+        CONNECTION_LOOPS = getCpuListProperty("CONNECTION_LOOPS", "");
+        AGGREGATION_INTERVAL_MS = getLongProperty("AGGREGATION_INTERVAL_MS", "100");
+        WEBSOCKET_CODEC = WebSocketCodec.valueOf(getProperty("WEBSOCKET_CODEC", "NETTY").toUpperCase());
+        WS_DEFLATE = getBooleanProperty("WS_DEFLATE", "false");
+        WS_DEFLATE_OUTBOUND = getBooleanProperty("WS_DEFLATE_OUTBOUND", "true");
+        WS_DEFLATE_MIN_SIZE = getIntegerProperty("WS_DEFLATE_MIN_SIZE", "0");
+        WS_DEFLATE_LEVEL = getIntegerProperty("WS_DEFLATE_LEVEL", "6");
+        WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER = getBooleanProperty("WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER", "false");
+        WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER = getBooleanProperty("WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER", "false");
         EXCHANGE_CLIENT_COUNT = getIntegerProperty("EXCHANGE_CLIENT_COUNT", "16");
         WARMUP_COUNT = getLongProperty("WARMUP_COUNT", "5");
+        IN_FLIGHT_TABLE_CAPACITY = getIntegerProperty("IN_FLIGHT_TABLE_CAPACITY", "1024");
+        CLIENT_ID_MODE = ClientIdGenerator.Mode.valueOf(getProperty("CLIENT_ID_MODE", "SEQUENTIAL").toUpperCase());
+        PROTOCOL_ENCODING = ExchangeProtocol.Encoding.valueOf(getProperty("PROTOCOL_ENCODING", "JSON").toUpperCase());
+        LOAD_MODE = LoadMode.valueOf(getProperty("LOAD_MODE", "CLOSED_LOOP").toUpperCase());
+        TARGET_RATE_PER_CONNECTION = getLongProperty("TARGET_RATE_PER_CONNECTION", "0");
+        REPLAY_FILE = getProperty("REPLAY_FILE", "");
+        SCENARIO_FILE = getProperty("SCENARIO_FILE", "");
+        DECIMAL_SCALES = new DecimalScales(DecimalScales.parse(getProperty("PRICE_SCALES", "")),
+                DecimalScales.parse(getProperty("AMOUNT_SCALES", "")));
+        IN_FLIGHT_WINDOW = getIntegerProperty("IN_FLIGHT_WINDOW", "1");
+        CROSSING_ORDER_INTERVAL = getLongProperty("CROSSING_ORDER_INTERVAL", "0");
+        CROSSING_ORDER_AMOUNT = getLongProperty("CROSSING_ORDER_AMOUNT", "1");
+        KERNEL_TIMESTAMPING = KernelTimestamping.Mode.valueOf(getProperty("KERNEL_TIMESTAMPING", "NONE").toUpperCase());
 
     }
 
@@ -84,6 +159,22 @@ public class Config {
         return Arrays.stream(getProperty(key,defaultValue).split(",")).collect(Collectors.toList());
     }
 
+    /**
+     * Parses a list of numbers in the kernel's CPU list format, e.g. "2-5,8".
+     */
+    private static int[] getCpuListProperty(String key, String defaultValue){
+        return Arrays.stream(getProperty(key, defaultValue).split(","))
+                .map(String::trim)
+                .filter(range -> !range.isEmpty())
+                .flatMapToInt(range -> {
+                    int dash = range.indexOf('-');
+                    return dash < 0
+                            ? IntStream.of(Integer.parseInt(range))
+                            : IntStream.rangeClosed(Integer.parseInt(range.substring(0, dash)), Integer.parseInt(range.substring(dash + 1)));
+                })
+                .toArray();
+    }
+
     private static int getIntegerProperty(String key, String defaultValue){
         return Integer.parseInt(getProperty(key,defaultValue));
     }
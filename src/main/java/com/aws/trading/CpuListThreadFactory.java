@@ -0,0 +1,51 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import net.openhft.affinity.Affinity;
+
+import java.util.concurrent.ThreadFactory;
+
+/**
+ * Pins each thread it creates to the next CPU of an explicit list, e.g. the cores isolated with isolcpus in
+ * deployment/tune.sh. Creating more threads than CPUs wraps around the list.
+ */
+public final class CpuListThreadFactory implements ThreadFactory {
+    private final String name;
+    private final int[] cpus;
+    private int created;
+
+    public CpuListThreadFactory(String name, int[] cpus) {
+        if (cpus.length == 0) {
+            throw new IllegalArgumentException("CPU list of " + name + " is empty");
+        }
+        this.name = name;
+        this.cpus = cpus.clone();
+    }
+
+    @Override
+    public synchronized Thread newThread(Runnable r) {
+        final int cpu = cpus[created++ % cpus.length];
+        final Thread thread = new Thread(() -> {
+            Affinity.setAffinity(cpu);
+            r.run();
+        }, name + "-cpu" + cpu);
+        thread.setDaemon(true);
+        return thread;
+    }
+}
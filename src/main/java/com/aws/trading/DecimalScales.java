@@ -0,0 +1,73 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Decimal places of each instrument's prices and amounts on the wire. The client keeps prices and amounts as longs in
+ * units of the last decimal place, see {@link AsciiNumbers#writeDecimal}, and only the JSON encoders and decoders
+ * apply the scale; binary messages carry the longs as they are. Instruments without a scale are integers.
+ */
+public final class DecimalScales {
+    public static final DecimalScales NONE = new DecimalScales(Map.of(), Map.of());
+
+    private final Map<String, Integer> priceScales;
+    private final Map<String, Integer> amountScales;
+
+    public DecimalScales(Map<String, Integer> priceScales, Map<String, Integer> amountScales) {
+        this.priceScales = checked(priceScales);
+        this.amountScales = checked(amountScales);
+    }
+
+    /**
+     * Parses a list of instrument and scale pairs, e.g. "BTC_USDT:2,ETH_USDT:4".
+     */
+    public static Map<String, Integer> parse(String list) {
+        final Map<String, Integer> scales = new HashMap<>();
+        for (String entry : list.split(",")) {
+            if (entry.isBlank()) {
+                continue;
+            }
+            final int colon = entry.indexOf(':');
+            if (colon < 0) {
+                throw new IllegalArgumentException("scale " + entry + " is not INSTRUMENT:DECIMAL_PLACES");
+            }
+            scales.put(entry.substring(0, colon).trim(), Integer.parseInt(entry.substring(colon + 1).trim()));
+        }
+        return scales;
+    }
+
+    private static Map<String, Integer> checked(Map<String, Integer> scales) {
+        scales.forEach((instrument, scale) -> {
+            if (scale < 0 || scale > AsciiNumbers.MAX_SCALE) {
+                throw new IllegalArgumentException("scale of " + instrument + " must be between 0 and " + AsciiNumbers.MAX_SCALE);
+            }
+        });
+        return Map.copyOf(scales);
+    }
+
+    public int priceScale(String pair) {
+        return priceScales.getOrDefault(pair, 0);
+    }
+
+    public int amountScale(String pair) {
+        return amountScales.getOrDefault(pair, 0);
+    }
+}
@@ -20,11 +20,9 @@ package com.aws.trading;
 import io.netty.bootstrap.Bootstrap;
 import io.netty.channel.*;
 import io.netty.channel.socket.SocketChannel;
-import io.netty.channel.socket.nio.NioSocketChannel;
 import io.netty.handler.codec.http.HttpClientCodec;
 import io.netty.handler.codec.http.HttpObjectAggregator;
 import io.netty.handler.codec.http.websocketx.CloseWebSocketFrame;
-import io.netty.incubator.channel.uring.IOUringSocketChannel;
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
@@ -34,7 +32,9 @@ import java.net.http.HttpRequest;
 import java.net.http.HttpResponse;
 import java.time.Duration;
 
-import static com.aws.trading.Config.USE_IOURING;
+import static com.aws.trading.Config.FRAMING;
+import static com.aws.trading.Config.TRANSPORT;
+import static com.aws.trading.Config.WS_DEFLATE;
 
 public class ExchangeClient {
     private static final Logger LOGGER = LogManager.getLogger(ExchangeClient.class);
@@ -46,10 +46,14 @@ public class ExchangeClient {
     private Bootstrap bootstrap;
 
 
-    public ExchangeClient(int apiToken, ExchangeClientLatencyTestHandler handler, MultithreadEventLoopGroup ioGroup, MultithreadEventLoopGroup workerGroup) {
+    /**
+     * @param ioLoop      loop, or group of loops, the connection's channel is registered with
+     * @param workerGroup group the latency test handler runs on, or null to run it on the channel's own loop
+     */
+    public ExchangeClient(int apiToken, ExchangeClientLatencyTestHandler handler, EventLoopGroup ioLoop, EventLoopGroup workerGroup) {
         this.apiToken = apiToken;
         this.handler = handler;
-        this.bootstrap = configureBootstrap(ioGroup).handler(getChannelInitializer(workerGroup, handler));
+        this.bootstrap = configureBootstrap(ioLoop).handler(getChannelInitializer(workerGroup, handler));
         this.workerGroup = workerGroup;
         this.httpClient = HttpClient
                 .newBuilder()
@@ -57,10 +61,8 @@ public class ExchangeClient {
                 .build();
     }
 
-    private static Bootstrap configureBootstrap(MultithreadEventLoopGroup workerGroup) {
-        return new Bootstrap()
-                .group(workerGroup)
-                .channel(USE_IOURING ? IOUringSocketChannel.class : NioSocketChannel.class)
+    private static Bootstrap configureBootstrap(EventLoopGroup ioLoop) {
+        return TRANSPORT.configure(new Bootstrap().group(ioLoop))
                 .option(ChannelOption.SO_KEEPALIVE, true);
     }
 
@@ -89,25 +91,43 @@ public class ExchangeClient {
 
 
     public void connect() throws InterruptedException {
-        LOGGER.info("ExchangeClient is connecting via websocket to {}:{}", handler.uri.getHost(), handler.uri.getPort());
+        LOGGER.info("ExchangeClient is connecting via {} to {}:{}", FRAMING, handler.uri.getHost(), handler.uri.getPort());
         this.ch = this.bootstrap.connect(handler.uri.getHost(), handler.uri.getPort()).sync().channel();
     }
 
-    private static ChannelInitializer<SocketChannel> getChannelInitializer(MultithreadEventLoopGroup workerGroup, ExchangeClientLatencyTestHandler handler) {
+    private static ChannelInitializer<SocketChannel> getChannelInitializer(EventLoopGroup workerGroup, ExchangeClientLatencyTestHandler handler) {
         return new ChannelInitializer<>() {
             @Override
             public void initChannel(SocketChannel channel) throws Exception {
                 ChannelPipeline pipeline = channel.pipeline();
-                pipeline.addLast("http-codec", new HttpClientCodec());
-                pipeline.addLast("aggregator", new HttpObjectAggregator(65536));
-                pipeline.addLast(workerGroup, "ws-handler", handler);
+                pipeline.addLast("rx-timestamp", handler.receiveTimestamps().readStamper());
+                if (FRAMING == Framing.TCP) {
+                    pipeline.addLast("frame-decoder", LengthPrefixedFrameEncoder.newDecoder(ExchangeClientLatencyTestHandler.MAX_FRAME_PAYLOAD_LENGTH));
+                    pipeline.addLast("frame-encoder", LengthPrefixedFrameEncoder.INSTANCE);
+                } else {
+                    pipeline.addLast("http-codec", new HttpClientCodec());
+                    pipeline.addLast("aggregator", new HttpObjectAggregator(65536));
+                    if (WS_DEFLATE) {
+                        pipeline.addLast("ws-compression", WebSocketCompression.newExtensionHandler());
+                    }
+                }
+                pipeline.addLast("rx-frame-timestamp", handler.receiveTimestamps().frameStamper());
+                if (workerGroup == null) {
+                    pipeline.addLast("ws-handler", handler);
+                } else {
+                    pipeline.addLast(workerGroup, "ws-handler", handler);
+                }
             }
         };
     }
 
     public void close() throws InterruptedException {
         //System.out.println("WebSocket Client sending close");
-        ch.writeAndFlush(new CloseWebSocketFrame());
+        if (FRAMING == Framing.TCP) {
+            ch.close();
+        } else {
+            ch.writeAndFlush(new CloseWebSocketFrame());
+        }
         ch.closeFuture().sync();
         //group.shutdownGracefully();
     }
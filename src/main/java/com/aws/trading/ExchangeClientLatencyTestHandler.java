@@ -17,14 +17,14 @@
  */
 package com.aws.trading;
 
-import com.alibaba.fastjson2.JSON;
-import com.alibaba.fastjson2.JSONObject;
 import io.netty.buffer.ByteBuf;
+import io.netty.buffer.ByteBufUtil;
 import io.netty.buffer.Unpooled;
 import io.netty.channel.Channel;
 import io.netty.channel.ChannelHandlerContext;
 import io.netty.channel.ChannelInboundHandlerAdapter;
 import io.netty.channel.ChannelPromise;
+import io.netty.channel.epoll.EpollMode;
 import io.netty.handler.codec.http.FullHttpResponse;
 import io.netty.handler.codec.http.HttpHeaders;
 import io.netty.handler.codec.http.websocketx.*;
@@ -36,38 +36,132 @@ import org.apache.logging.log4j.Logger;
 import java.net.URI;
 import java.nio.charset.StandardCharsets;
 import java.util.Random;
-import java.util.UUID;
-import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.TimeUnit;
 
+import static com.aws.trading.Config.CLIENT_ID_MODE;
 import static com.aws.trading.Config.COIN_PAIRS;
-import static com.aws.trading.RoundTripLatencyTester.printResults;
+import static com.aws.trading.Config.CROSSING_ORDER_AMOUNT;
+import static com.aws.trading.Config.CROSSING_ORDER_INTERVAL;
+import static com.aws.trading.Config.EPOLL_MODE;
+import static com.aws.trading.Config.DECIMAL_SCALES;
+import static com.aws.trading.Config.FRAMING;
+import static com.aws.trading.Config.IN_FLIGHT_TABLE_CAPACITY;
+import static com.aws.trading.Config.IN_FLIGHT_WINDOW;
+import static com.aws.trading.Config.KERNEL_TIMESTAMPING;
+import static com.aws.trading.Config.LOAD_MODE;
+import static com.aws.trading.Config.TARGET_RATE_PER_CONNECTION;
+import static com.aws.trading.Config.TRANSPORT;
+import static com.aws.trading.Config.WEBSOCKET_CODEC;
+import static com.aws.trading.Config.WS_DEFLATE;
 
 public class ExchangeClientLatencyTestHandler extends ChannelInboundHandlerAdapter {
     private static final Logger LOGGER = LogManager.getLogger(ExchangeClientLatencyTestHandler.class);
+    private static final long SEND_TIME_NOW = Long.MIN_VALUE;
+    static final int MAX_FRAME_PAYLOAD_LENGTH = 1280000;
+    private static final byte[][] COIN_PAIR_BYTES = COIN_PAIRS.stream()
+            .map(pair -> pair.getBytes(StandardCharsets.US_ASCII))
+            .toArray(byte[][]::new);
     private final WebSocketClientHandshaker handshaker;
     private final int apiToken;
-    private final int test_size;
     public final URI uri;
     private final ExchangeProtocol protocol;
     private ChannelPromise handshakeFuture;
-    private final ConcurrentHashMap<String, Long> orderSentTimeMap;
-    private final ConcurrentHashMap<String, Long> cancelSentTimeMap;
+    private final InFlightOrderTable orderSentTimeMap;
+    private final InFlightOrderTable cancelSentTimeMap;
+    private long priceMismatches;
+    private long droppedSamples;
     private long orderResponseCount = 0;
     private final SingleWriterRecorder hdrRecorderForAggregation;
     private long testStartTime = 0;
     private final Random random = new Random();
+    private final InboundMessageParser jsonParser = new InboundMessageParser();
+    private final ResponseDecoder responseDecoder;
+    private final ClientIdGenerator clientIds;
+    private final LoadMode loadMode;
+    private final long sendIntervalNanos;
+    private long nextIntendedSendTime;
+    private ScheduledFuture<?> sendSchedule;
+    private final int inFlightWindow;
+    private int inFlightPairs;
+    private long ordersWritten;
+    private boolean flushPending;
+    private final SingleWriterRecorder[] stageRecorders;
+    private final LatencyAggregator.Connection latency;
+    private final ReceiveTimestamps receiveTimestamps = new ReceiveTimestamps();
+    private final long[] unflushedIds;
+    private final long[] unflushedWriteTimes;
+    private final InFlightOrderTable[] unflushedTables;
+    private int unflushedCount;
+    private KernelTimestamping kernelTimestamping;
+    private final ReplayFile.Cursor replay;
+    private ScheduledFuture<?> replayWakeUp;
+    private long ordersReplayed;
+    private final Scenario scenario;
+    private final Scenario.Session flows;
 
-    public ExchangeClientLatencyTestHandler(ExchangeProtocol protocol, URI uri, int apiToken, int test_size) {
+    /**
+     * @param replay   this connection's share of the REPLAY_FILE in REPLAY load mode, null otherwise
+     * @param scenario order flow mix of SCENARIO_FILE, null to send the default buy orders
+     */
+    public ExchangeClientLatencyTestHandler(ExchangeProtocol protocol, URI uri, int apiToken, LatencyAggregator.Connection latency,
+                                            ReplayFile.Cursor replay, Scenario scenario) {
         this.uri = uri;
         this.protocol = protocol;
+        // auth and subscription replies stay JSON whatever the order entry protocol is
+        this.responseDecoder = protocol.isBinary() ? protocol.newResponseDecoder() : jsonParser;
         var header = HttpHeaders.EMPTY_HEADERS;
-        this.handshaker = WebSocketClientHandshakerFactory.newHandshaker(
-                uri, WebSocketVersion.V13, null, false, header, 1280000);
+        // TCP framing has no handshake
+        this.handshaker = FRAMING == Framing.WEBSOCKET ? WebSocketClientHandshakerFactory.newHandshaker(
+                uri, WebSocketVersion.V13, null, WS_DEFLATE, header, MAX_FRAME_PAYLOAD_LENGTH) : null;
         this.apiToken = apiToken;
-        this.orderSentTimeMap = new ConcurrentHashMap<>(test_size);
-        this.cancelSentTimeMap = new ConcurrentHashMap<>(test_size);
-        this.test_size = test_size;
-        this.hdrRecorderForAggregation = new SingleWriterRecorder(Long.MAX_VALUE, 2);
+        this.clientIds = ClientIdGenerator.create(CLIENT_ID_MODE, apiToken);
+        this.orderSentTimeMap = new OpenAddressingInFlightTable(IN_FLIGHT_TABLE_CAPACITY);
+        this.cancelSentTimeMap = new OpenAddressingInFlightTable(IN_FLIGHT_TABLE_CAPACITY);
+        this.latency = latency;
+        this.hdrRecorderForAggregation = latency.roundTrips();
+        this.stageRecorders = latency.stages();
+        this.loadMode = LOAD_MODE;
+        if (loadMode == LoadMode.OPEN_LOOP && TARGET_RATE_PER_CONNECTION <= 0) {
+            throw new IllegalArgumentException("OPEN_LOOP load mode requires a positive TARGET_RATE_PER_CONNECTION");
+        }
+        if (loadMode == LoadMode.REPLAY && replay == null) {
+            throw new IllegalArgumentException("REPLAY load mode requires a REPLAY_FILE");
+        }
+        this.replay = replay;
+        if (loadMode == LoadMode.REPLAY && scenario != null) {
+            throw new IllegalArgumentException("REPLAY load mode can't run a SCENARIO_FILE");
+        }
+        this.scenario = scenario;
+        this.flows = scenario != null ? scenario.newSession(IN_FLIGHT_TABLE_CAPACITY) : null;
+        this.sendIntervalNanos = TARGET_RATE_PER_CONNECTION > 0 ? TimeUnit.SECONDS.toNanos(1) / TARGET_RATE_PER_CONNECTION : 0;
+        if (IN_FLIGHT_WINDOW <= 0 || IN_FLIGHT_WINDOW > IN_FLIGHT_TABLE_CAPACITY) {
+            throw new IllegalArgumentException("IN_FLIGHT_WINDOW must be between 1 and IN_FLIGHT_TABLE_CAPACITY");
+        }
+        this.inFlightWindow = IN_FLIGHT_WINDOW;
+        this.unflushedIds = new long[2 * IN_FLIGHT_TABLE_CAPACITY];
+        this.unflushedWriteTimes = new long[2 * IN_FLIGHT_TABLE_CAPACITY];
+        this.unflushedTables = new InFlightOrderTable[2 * IN_FLIGHT_TABLE_CAPACITY];
+        if (WS_DEFLATE && FRAMING == Framing.TCP) {
+            throw new IllegalArgumentException("WS_DEFLATE needs WEBSOCKET framing");
+        }
+        if (WS_DEFLATE && WEBSOCKET_CODEC == WebSocketCodec.FAST) {
+            throw new IllegalArgumentException("WS_DEFLATE needs the NETTY WebSocket codec");
+        }
+        if (KERNEL_TIMESTAMPING != KernelTimestamping.Mode.NONE && WS_DEFLATE) {
+            // compressed frame sizes aren't known when the frame is written, so frames can't be matched to TX stamps
+            LOGGER.error("kernel timestamping can't be combined with WS_DEFLATE, kernel timestamping is off");
+        } else if (KERNEL_TIMESTAMPING != KernelTimestamping.Mode.NONE
+                && (TRANSPORT != Transport.EPOLL || EPOLL_MODE != EpollMode.EDGE_TRIGGERED)) {
+            // stamps wait in the error queue until a response arrives, which keeps a level triggered socket readable
+            LOGGER.error("kernel timestamping needs TRANSPORT=EPOLL with EPOLL_MODE=EDGE_TRIGGERED, kernel timestamping is off");
+        } else if (KERNEL_TIMESTAMPING != KernelTimestamping.Mode.NONE) {
+            this.kernelTimestamping = new KernelTimestamping(KERNEL_TIMESTAMPING, FRAMING, IN_FLIGHT_TABLE_CAPACITY);
+        }
+    }
+
+    public ReceiveTimestamps receiveTimestamps() {
+        return receiveTimestamps;
     }
 
     @Override
@@ -77,6 +171,11 @@ public class ExchangeClientLatencyTestHandler extends ChannelInboundHandlerAdapt
 
     @Override
     public void channelActive(final ChannelHandlerContext ctx) throws Exception {
+        if (handshaker == null) {
+            LOGGER.info("channel is active");
+            authenticate(ctx);
+            return;
+        }
         LOGGER.info("channel is active, starting websocket handshaking...");
         handshaker.handshake(ctx.channel());
     }
@@ -84,21 +183,57 @@ public class ExchangeClientLatencyTestHandler extends ChannelInboundHandlerAdapt
     @Override
     public void channelInactive(final ChannelHandlerContext ctx) throws Exception {
         LOGGER.info("Websocket client disconnected");
+        if (sendSchedule != null) {
+            sendSchedule.cancel(false);
+        }
+        if (replayWakeUp != null) {
+            replayWakeUp.cancel(false);
+        }
+        if (priceMismatches > 0) {
+            LOGGER.error("{} orders were booked at another price than they were sent at", priceMismatches);
+        }
+        if (droppedSamples > 0) {
+            LOGGER.error("{} samples were dropped because an in-flight table was full", droppedSamples);
+        }
+    }
+
+    @Override
+    public void channelWritabilityChanged(ChannelHandlerContext ctx) throws Exception {
+        if (ctx.channel().isWritable()) {
+            if (sendSchedule != null) {
+                sendDueOrders(ctx);
+            } else if (loadMode == LoadMode.REPLAY && testStartTime != 0) {
+                replayDueOrders(ctx);
+            } else if (testStartTime != 0) {
+                fillWindow(ctx);
+            }
+            flushIfPending(ctx);
+        }
+        super.channelWritabilityChanged(ctx);
+    }
+
+    /**
+     * Everything written while handling one read batch goes out in a single flush.
+     */
+    @Override
+    public void channelReadComplete(ChannelHandlerContext ctx) throws Exception {
+        flushIfPending(ctx);
+        super.channelReadComplete(ctx);
     }
 
     @Override
     public void channelRead(ChannelHandlerContext ctx, Object msg) throws Exception {
         final Channel ch = ctx.channel();
-        if (!handshaker.isHandshakeComplete()) {
+        if (handshaker != null && !handshaker.isHandshakeComplete()) {
             LOGGER.info("Websocket client is connected");
             var m = (FullHttpResponse) msg;
             handshaker.finishHandshake(ch, m);
-            LOGGER.info("Websocket client is authenticating for {}", this.apiToken);
+            WEBSOCKET_CODEC.install(ch.pipeline(), MAX_FRAME_PAYLOAD_LENGTH, protocol.isBinary());
+            if (WS_DEFLATE) {
+                WebSocketCompression.installTimers(ch.pipeline(), stageRecorders[LatencyStage.COMPRESSION.ordinal()]);
+            }
             //success, authenticate
-            var channel = ctx.channel();
-            channel.write(authMessage());
-            channel.flush();
-            handshakeFuture.setSuccess();
+            authenticate(ctx);
             return;
         }
 
@@ -107,9 +242,19 @@ public class ExchangeClientLatencyTestHandler extends ChannelInboundHandlerAdapt
             throw new Exception("Unexpected FullHttpResponse (getStatus=" + response.getStatus() + ", content="
                     + response.content().toString(CharsetUtil.UTF_8) + ')');
         }
+        final long firstReadTime = receiveTimestamps.poll();
+        if (msg instanceof ByteBuf) {
+            // a FAST codec frame or a TCP message; JSON always starts with '{', which no binary header does
+            final ByteBuf buf = (ByteBuf) msg;
+            final boolean json = buf.isReadable() && buf.getByte(buf.readerIndex()) == '{';
+            this.onMessage(ctx, buf, firstReadTime, json ? jsonParser : responseDecoder);
+            return;
+        }
         final WebSocketFrame frame = (WebSocketFrame) msg;
         if (frame instanceof TextWebSocketFrame) {
-            this.onTextWebSocketFrame(ctx, (TextWebSocketFrame) frame);
+            this.onMessage(ctx, frame.content(), firstReadTime, jsonParser);
+        } else if (frame instanceof BinaryWebSocketFrame && protocol.isBinary()) {
+            this.onMessage(ctx, frame.content(), firstReadTime, responseDecoder);
         } else if (frame instanceof PongWebSocketFrame) {
         } else if (frame instanceof CloseWebSocketFrame) {
             LOGGER.info("received CloseWebSocketFrame, closing the channel");
@@ -120,6 +265,21 @@ public class ExchangeClientLatencyTestHandler extends ChannelInboundHandlerAdapt
 
     }
 
+    private void authenticate(ChannelHandlerContext ctx) {
+        if (kernelTimestamping != null && !kernelTimestamping.enable(ctx.channel())) {
+            kernelTimestamping = null;
+        }
+        LOGGER.info("Exchange client is authenticating for {}", this.apiToken);
+        var channel = ctx.channel();
+        var auth = authMessage();
+        if (kernelTimestamping != null) {
+            kernelTimestamping.onFrameWritten(auth.content().readableBytes());
+        }
+        channel.write(auth);
+        channel.flush();
+        handshakeFuture.setSuccess();
+    }
+
     private TextWebSocketFrame subscribeMessage() {
         return new TextWebSocketFrame(Unpooled.wrappedBuffer(ExchangeProtocolImpl.SUBSCRIBE_MSG));
     }
@@ -145,94 +305,421 @@ public class ExchangeClientLatencyTestHandler extends ChannelInboundHandlerAdapt
         return handshakeFuture;
     }
 
-    private void onTextWebSocketFrame(ChannelHandlerContext ctx, TextWebSocketFrame textFrame) throws InterruptedException {
+    private void onMessage(ChannelHandlerContext ctx, ByteBuf buf, long firstReadTime, ResponseDecoder decoder) throws InterruptedException {
         long eventReceiveTime = System.nanoTime();
-        ByteBuf buf = textFrame.content();
-
-        final byte[] bytes;
-        int offset = 0;
-        final int length = buf.readableBytes();
-        if (buf.hasArray()) {
-            bytes = buf.array();
-            offset = buf.arrayOffset();
-        } else {
-            bytes = new byte[length];
-            buf.getBytes(buf.readerIndex(), bytes);
-        }
-        buf.clear();
-        buf.release();
-
-        JSONObject parsedObject = JSON.parseObject(bytes, offset, bytes.length - offset, StandardCharsets.UTF_8);
-        Object type = parsedObject.getString("type");
-
-        if ("BOOKED".equals(type) || type.equals("DONE")) {
-            //LOGGER.info("eventTime: {}, received ACK: {}",eventReceiveTime, parsedObject);
-            String clientId = parsedObject.getString("client_id");
-            if (type.equals("BOOKED")) {
-                if (calculateRoundTrip(eventReceiveTime, clientId, orderSentTimeMap)) return;
-                var pair = parsedObject.getString("instrument_code");
-                sendCancelOrder(ctx, clientId, pair);
+        try {
+            if (!decoder.parse(buf)) {
+                LOGGER.error("Unparseable message {}", decoder == jsonParser ? buf.toString(StandardCharsets.UTF_8) : ByteBufUtil.hexDump(buf));
+                return;
+            }
+            long decodedTime = System.nanoTime();
+            MessageType type = decoder.messageType();
+
+            if (type == MessageType.BOOKED || type == MessageType.FILL || type == MessageType.DONE) {
+                //LOGGER.info("eventTime: {}, received ACK: {}",eventReceiveTime, buf.toString(StandardCharsets.UTF_8));
+                if (firstReadTime != ReceiveTimestamps.EMPTY) {
+                    recordStage(LatencyStage.INBOUND, eventReceiveTime - firstReadTime);
+                }
+                recordStage(LatencyStage.DECODE, decodedTime - eventReceiveTime);
+                if (type == MessageType.FILL) {
+                    // the BOOKED or DONE that follows ends the round trip
+                    return;
+                }
+                long clientOrderId = decoder.clientOrderId(clientIds);
+                if (type == MessageType.BOOKED) {
+                    var pair = resolvePair(decoder.instrumentCode());
+                    calculateRoundTrip(eventReceiveTime, firstReadTime, clientOrderId, orderSentTimeMap, decoder);
+                    checkBookedPrice(decoder, clientOrderId, pair, orderSentTimeMap.lastRemovedPrice());
+                    sendCancelOrder(ctx, decoder.clientId(), clientOrderId, pair);
+                } else {
+                    var status = decoder.status();
+                    var sentTimeTable = completedTable(status, clientOrderId);
+                    if (sentTimeTable == null) {
+                        return;
+                    }
+                    inFlightPairs--;
+                    if (flows != null) {
+                        continueFlow(ctx, clientOrderId, status);
+                    }
+                    calculateRoundTrip(eventReceiveTime, firstReadTime, clientOrderId, sentTimeTable, decoder);
+                    if (loadMode == LoadMode.CLOSED_LOOP) {
+                        fillWindow(ctx);
+                    }
+                }
+                if (loadMode == LoadMode.OPEN_LOOP) {
+                    sendDueOrders(ctx);
+                } else if (loadMode == LoadMode.REPLAY) {
+                    replayDueOrders(ctx);
+                }
+            } else if (type == MessageType.AUTHENTICATED) {
+                LOGGER.info("{}", buf.toString(StandardCharsets.UTF_8));
+                var subscribe = subscribeMessage();
+                if (kernelTimestamping != null) {
+                    kernelTimestamping.onFrameWritten(subscribe.content().readableBytes());
+                }
+                ctx.channel().writeAndFlush(subscribe);
+            } else if (type == MessageType.SUBSCRIPTIONS) {
+                LOGGER.info("{}", buf.toString(StandardCharsets.UTF_8));
+                this.testStartTime = System.nanoTime();
+                if (loadMode == LoadMode.OPEN_LOOP) {
+                    startOpenLoop(ctx);
+                } else if (loadMode == LoadMode.REPLAY) {
+                    replay.start(testStartTime, () -> ctx.executor().execute(() -> replayDueOrders(ctx)));
+                } else {
+                    fillWindow(ctx);
+                    flushIfPending(ctx);
+                }
             } else {
-                if (calculateRoundTrip(eventReceiveTime, clientId, cancelSentTimeMap)) return;
-                sendOrder(ctx);
+                LOGGER.error("Unhandled object {}", buf.toString(StandardCharsets.UTF_8));
             }
-            if (orderResponseCount % test_size == 0) {
-                printResults(hdrRecorderForAggregation, test_size);
+        } finally {
+            buf.release();
+        }
+    }
+
+    /**
+     * Reads the price of a BOOKED back at the pair's scale and compares it with the price the order was sent at, which
+     * catches a venue or a PRICE_SCALES setting that disagrees with the encoder. Only the first mismatch is logged.
+     */
+    private void checkBookedPrice(ResponseDecoder decoder, long clientOrderId, String pair, long sentPrice) {
+        final long bookedPrice = decoder.price(DECIMAL_SCALES.priceScale(pair));
+        if (sentPrice == InFlightOrderTable.MISSING || bookedPrice == ResponseDecoder.NO_VALUE || bookedPrice == sentPrice) {
+            return;
+        }
+        if (priceMismatches++ == 0) {
+            LOGGER.error("order {} on {} was sent at {} but booked at {}, check PRICE_SCALES", clientOrderId, pair, sentPrice, bookedPrice);
+        }
+    }
+
+    /**
+     * Which request a DONE answers, and so which sent time its round trip starts at: the order when it was never
+     * booked, i.e. filled in full, rejected, or an IOC or market order cancelled for what didn't trade; otherwise its
+     * cancel. Null when a booked order is filled while its cancel is in flight, as the cancel's own DONE ends the pair.
+     * Venues without a status only cancel.
+     */
+    private InFlightOrderTable completedTable(OrderStatus status, long clientOrderId) {
+        if (orderSentTimeMap.contains(clientOrderId)) {
+            return orderSentTimeMap;
+        }
+        if (status != OrderStatus.FILLED) {
+            return cancelSentTimeMap;
+        }
+        return null;
+    }
+
+    /**
+     * Maps the instrument code of a response back to the configured pair, or the replayed or scenario's instrument, so
+     * no String is created per message.
+     */
+    private String resolvePair(AsciiView instrumentCode) {
+        for (int i = 0; i < COIN_PAIR_BYTES.length; i++) {
+            if (instrumentCode.contentEquals(COIN_PAIR_BYTES[i])) {
+                return COIN_PAIRS.get(i);
             }
-        } else if ("AUTHENTICATED".equals(type)) {
-            LOGGER.info("{}", parsedObject);
-            ctx.channel().writeAndFlush(subscribeMessage());
-        } else if ("SUBSCRIPTIONS".equals(type)) {
-            LOGGER.info("{}", parsedObject);
-            this.testStartTime = System.nanoTime();
-            sendOrder(ctx);
-        } else {
-            LOGGER.error("Unhandled object {}", parsedObject);
         }
+        final String replayed = replay != null ? replay.instrument(instrumentCode) : null;
+        if (replayed != null) {
+            return replayed;
+        }
+        final String scenarioInstrument = scenario != null ? scenario.instrument(instrumentCode) : null;
+        return scenarioInstrument != null ? scenarioInstrument : instrumentCode.toString();
     }
 
-    private void sendCancelOrder(ChannelHandlerContext ctx, String clientId, String pair) {
-        TextWebSocketFrame cancelOrder = protocol.createCancelOrder(pair, clientId);
-        //LOGGER.info("Sending cancel order seq: {}, order: {}", sequence, cancelOrder.toString(StandardCharsets.UTF_8));
-        try {
-            ctx.channel().write(cancelOrder, ctx.channel().voidPromise()).await();
-        } catch (InterruptedException e) {
-            LOGGER.error(e);
+    private void sendCancelOrder(ChannelHandlerContext ctx, AsciiView clientId, long clientOrderId, String pair) {
+        var encodeStartTime = System.nanoTime();
+        WebSocketFrame cancelOrder = protocol.createCancelOrder(pair, clientId);
+        var encodedTime = System.nanoTime();
+        if (kernelTimestamping != null) {
+            if (!kernelTimestamping.onFrameWritten(true, clientOrderId, cancelOrder.content().readableBytes())) {
+                dropSample("TX offset", clientOrderId);
+            }
         }
+        //LOGGER.info("Sending cancel order seq: {}, order: {}", sequence, cancelOrder.toString(StandardCharsets.UTF_8));
+        ctx.write(cancelOrder, ctx.voidPromise());
         var cancelSentTime = System.nanoTime();
+        recordStage(LatencyStage.ENCODE, encodedTime - encodeStartTime);
         //LOGGER.info("cancel sent time for clientId: {} - {}",clientId, cancelSentTime);
-        this.cancelSentTimeMap.put(clientId, cancelSentTime);
-        ctx.channel().flush();
-        orderResponseCount += 1;
+        if (!this.cancelSentTimeMap.put(clientOrderId, cancelSentTime)) {
+            dropSample("cancel", clientOrderId);
+        }
+        addUnflushed(clientOrderId, cancelSentTime, cancelSentTimeMap);
+        latency.messageCount(++orderResponseCount);
     }
 
-    private boolean calculateRoundTrip(long eventReceiveTime, String clientId, ConcurrentHashMap<String, Long> cancelSentTimeMap) {
+    /**
+     * Records the round trip a response ends. A response whose sent time is missing, because the in-flight table was
+     * full, is only logged: the caller still cancels or releases its slot in the window, so the pair isn't leaked.
+     */
+    private void calculateRoundTrip(long eventReceiveTime, long firstReadTime, long clientOrderId, InFlightOrderTable sentTimeTable,
+                                    ResponseDecoder decoder) {
         long roundTripTime;
-        Long cancelSentTime = cancelSentTimeMap.remove(clientId);
-        if (null == cancelSentTime || eventReceiveTime < cancelSentTime) {
-            LOGGER.error("no order sent time found for order {}", clientId);
-            return true;
+        long sentTime = sentTimeTable.remove(clientOrderId);
+        if (kernelTimestamping != null) {
+            long txTime = kernelTimestamping.takeTxTime(sentTimeTable == cancelSentTimeMap, clientOrderId);
+            if (txTime != InFlightOrderTable.MISSING && firstReadTime != ReceiveTimestamps.EMPTY) {
+                recordStage(LatencyStage.WIRE, firstReadTime - txTime);
+            }
+        }
+        if (InFlightOrderTable.MISSING == sentTime || eventReceiveTime < sentTime) {
+            LOGGER.error("no order sent time found for order {}", clientOrderId);
+            return;
+        }
+        long flushTime = sentTimeTable.lastRemovedFlushTime();
+        roundTripTime = eventReceiveTime - sentTime;
+        long networkTime = roundTripTime;
+        if (flushTime != 0 && firstReadTime != ReceiveTimestamps.EMPTY) {
+            networkTime = firstReadTime - flushTime;
+            recordStage(LatencyStage.NETWORK, networkTime);
         }
-        roundTripTime = eventReceiveTime - cancelSentTime;
-        //LOGGER.info("round trip time for client id {}: {} = {} - {}", clientId, roundTripTime, eventReceiveTime, cancelSentTime);
+        recordServerTime(decoder, networkTime);
+        //LOGGER.info("round trip time for client id {}: {} = {} - {}", clientId, roundTripTime, eventReceiveTime, sentTime);
         if (roundTripTime > 0) {
             //LOGGER.info("recording round trip time");
-            hdrRecorderForAggregation.recordValue(roundTripTime);
+            if (loadMode == LoadMode.CLOSED_LOOP && sendIntervalNanos > 0) {
+                // closed loop can't send while it waits, so let HdrHistogram fill in the samples a stall swallowed
+                hdrRecorderForAggregation.recordValueWithExpectedInterval(roundTripTime, sendIntervalNanos);
+            } else {
+                hdrRecorderForAggregation.recordValue(roundTripTime);
+            }
         }
-        return false;
     }
 
-    void sendOrder(ChannelHandlerContext ch) throws InterruptedException {
+    /**
+     * Splits the network time of a response into the venue's residence time and the two trips over the network.
+     */
+    private void recordServerTime(ResponseDecoder decoder, long networkTime) {
+        final long serverReceiveTime = decoder.serverReceiveNanos();
+        final long serverSendTime = decoder.serverSendNanos();
+        if (serverReceiveTime == ResponseDecoder.NO_TIMESTAMP || serverSendTime == ResponseDecoder.NO_TIMESTAMP
+                || serverSendTime < serverReceiveTime) {
+            return;
+        }
+        final long serverTime = serverSendTime - serverReceiveTime;
+        recordStage(LatencyStage.SERVER, serverTime);
+        if (networkTime > serverTime) {
+            recordStage(LatencyStage.ONE_WAY, (networkTime - serverTime) / 2);
+        }
+    }
+
+    /**
+     * Keeps up to IN_FLIGHT_WINDOW order/cancel pairs outstanding on this connection. Back-pressure comes from the
+     * window itself and from the channel's writability; orders are only written here and flushed together later.
+     */
+    private void fillWindow(ChannelHandlerContext ctx) {
+        while (inFlightPairs < inFlightWindow && canSendOrder(ctx)) {
+            writeOrder(ctx, SEND_TIME_NOW);
+        }
+    }
+
+    /**
+     * Whether a new order, or a new flow of the scenario, fits into the in-flight tables and the channel.
+     */
+    private boolean canSendOrder(ChannelHandlerContext ctx) {
+        return hasInFlightCapacity()
+                && ctx.channel().isWritable()
+                && (flows == null || flows.hasFreeSlot());
+    }
 
+    /**
+     * Whether another order fits next to every order and cancel in flight. A booked order's entry moves to the cancel
+     * table, so bounding both together leaves room for the cancels of every order a stall answers at once.
+     */
+    private boolean hasInFlightCapacity() {
+        return orderSentTimeMap.size() + cancelSentTimeMap.size() < IN_FLIGHT_TABLE_CAPACITY;
+    }
+
+    /**
+     * Counts a response that can't be measured because its sent time or TX offset didn't fit in a full table, so the
+     * report shows the samples lost instead of them going missing from the histograms. Only the first is logged.
+     */
+    private void dropSample(String table, long clientOrderId) {
+        if (droppedSamples++ == 0) {
+            LOGGER.error("in-flight {} table is full, dropping the sample of {}", table, clientOrderId);
+        }
+        latency.droppedSamples(droppedSamples);
+    }
+
+    private void flushIfPending(ChannelHandlerContext ctx) {
+        if (flushPending) {
+            flushPending = false;
+            ctx.flush();
+            // on a worker loop the flush has only been queued for the netty-io loop, see LatencyStage.WRITE
+            final long flushTime = System.nanoTime();
+            for (int i = 0; i < unflushedCount; i++) {
+                recordStage(LatencyStage.WRITE, flushTime - unflushedWriteTimes[i]);
+                unflushedTables[i].markFlushed(unflushedIds[i], flushTime);
+                unflushedTables[i] = null;
+            }
+            unflushedCount = 0;
+        }
+    }
+
+    /**
+     * Remembers a written frame so its flush time can be attached once the pending flush happens.
+     */
+    private void addUnflushed(long clientOrderId, long writeTime, InFlightOrderTable sentTimeTable) {
+        if (unflushedCount < unflushedIds.length) {
+            unflushedIds[unflushedCount] = clientOrderId;
+            unflushedWriteTimes[unflushedCount] = writeTime;
+            unflushedTables[unflushedCount] = sentTimeTable;
+            unflushedCount++;
+        }
+        flushPending = true;
+    }
+
+    private void recordStage(LatencyStage stage, long nanos) {
+        if (nanos > 0) {
+            stageRecorders[stage.ordinal()].recordValue(nanos);
+        }
+    }
+
+    private void startOpenLoop(ChannelHandlerContext ctx) {
+        LOGGER.info("starting open loop load at {} orders per second", TARGET_RATE_PER_CONNECTION);
+        this.nextIntendedSendTime = System.nanoTime();
+        this.sendSchedule = ctx.executor().scheduleAtFixedRate(
+                () -> sendDueOrders(ctx), 0, sendIntervalNanos, TimeUnit.NANOSECONDS);
+    }
+
+    /**
+     * Sends every order whose slot on the fixed timeline has come, stamped with the slot's intended send time rather
+     * than the time it actually goes out. Slots that can't be sent because the in-flight table is full or the channel
+     * isn't writable stay due and are sent, still carrying their intended time, as soon as capacity frees up. A server
+     * stall therefore shows up as latency instead of as fewer samples.
+     */
+    private void sendDueOrders(ChannelHandlerContext ctx) {
+        final long now = System.nanoTime();
+        while (nextIntendedSendTime <= now && canSendOrder(ctx)) {
+            writeOrder(ctx, nextIntendedSendTime);
+            nextIntendedSendTime += sendIntervalNanos;
+        }
+        flushIfPending(ctx);
+    }
+
+    /**
+     * Sends every recorded order whose time on the replay's timeline has come, stamped with that time like the open
+     * loop's slots, and wakes up again when the next one is due. Orders held back by a full in-flight table or an
+     * unwritable channel go out as soon as a response or writability frees up capacity.
+     */
+    private void replayDueOrders(ChannelHandlerContext ctx) {
+        if (!replay.hasStarted()) {
+            return;
+        }
+        final long now = System.nanoTime();
+        while (replay.hasNext()
+                && replay.dueTime() <= now
+                && hasInFlightCapacity()
+                && ctx.channel().isWritable()) {
+            var clientId = clientIds.next();
+            var encodeStartTime = System.nanoTime();
+            var order = protocol.createOrder(replay.instrument(), replay.type(), replay.side(), clientIds, clientId,
+                    replay.price(), replay.amount());
+            writeOrder(ctx, clientId, order, replay.price(), encodeStartTime, replay.dueTime());
+            replay.advance();
+            ordersReplayed++;
+            if (!replay.hasNext()) {
+                LOGGER.info("replay finished after {} orders", ordersReplayed);
+            }
+        }
+        flushIfPending(ctx);
+        if (!replay.hasNext()) {
+            return;
+        }
+        final long due = replay.dueTime();
+        if (due > now && (replayWakeUp == null || replayWakeUp.isDone())) {
+            replayWakeUp = ctx.executor().schedule(() -> replayDueOrders(ctx), due - now, TimeUnit.NANOSECONDS);
+        }
+    }
+
+    /**
+     * Writes one order without flushing it.
+     *
+     * @param intendedSendTime time the order is recorded as sent at, or SEND_TIME_NOW to stamp it once it is written
+     */
+    private void writeOrder(ChannelHandlerContext ctx, long intendedSendTime) {
+        if (flows != null) {
+            writeFlowOrder(ctx, flows.start(), intendedSendTime);
+            return;
+        }
         var pair = COIN_PAIRS.get(random.nextInt(COIN_PAIRS.size()));
-        var clientId = UUID.randomUUID().toString();
-        var order = protocol.createBuyOrder(pair, clientId);
-        ch.write(order, ch.voidPromise()).await();
-        var time = System.nanoTime();
+        var clientId = clientIds.next();
+        var encodeStartTime = System.nanoTime();
+        // every CROSSING_ORDER_INTERVAL-th order sells at the price the others buy at, so resting orders get filled
+        var order = CROSSING_ORDER_INTERVAL > 0 && ++ordersWritten % CROSSING_ORDER_INTERVAL == 0
+                ? protocol.createLimitOrder(pair, Side.SELL, clientIds, clientId,
+                        TemplateExchangeProtocol.DEFAULT_PRICE, CROSSING_ORDER_AMOUNT)
+                : protocol.createBuyOrder(pair, clientIds, clientId);
+        writeOrder(ctx, clientId, order, TemplateExchangeProtocol.DEFAULT_PRICE, encodeStartTime, intendedSendTime);
+    }
+
+    /**
+     * Writes the current order of a scenario flow without flushing it.
+     */
+    private void writeFlowOrder(ChannelHandlerContext ctx, int slot, long intendedSendTime) {
+        var clientId = clientIds.next();
+        var encodeStartTime = System.nanoTime();
+        var order = protocol.createOrder(flows.instrument(slot), flows.type(slot), flows.side(slot), clientIds, clientId,
+                flows.price(slot), flows.amount(slot));
+        flows.sent(slot, clientId);
+        writeOrder(ctx, clientId, order, flows.price(slot), encodeStartTime, intendedSendTime);
+    }
+
+    /**
+     * Takes the flow a DONE belongs to to its next step: the replacement of an order whose cancel went through while
+     * the flow has replaces left, otherwise the end of the flow. Either can come after a think time, during which the
+     * flow keeps its place in the in-flight window.
+     */
+    private void continueFlow(ChannelHandlerContext ctx, long clientOrderId, OrderStatus status) {
+        final int slot = flows.completed(clientOrderId);
+        if (slot == Scenario.NO_SLOT) {
+            return;
+        }
+        final boolean replace = (status == OrderStatus.CANCELLED || status == OrderStatus.UNKNOWN) && flows.replace(slot);
+        final long think = flows.thinkNanos(slot);
+        if (!replace) {
+            flows.finish(slot);
+        }
+        if (think == 0 || (!replace && loadMode != LoadMode.CLOSED_LOOP)) {
+            if (replace) {
+                writeFlowOrder(ctx, slot, SEND_TIME_NOW);
+            }
+            return;
+        }
+        inFlightPairs++;
+        ctx.executor().schedule(() -> {
+            inFlightPairs--;
+            if (!ctx.channel().isActive()) {
+                return;
+            }
+            if (replace) {
+                writeFlowOrder(ctx, slot, SEND_TIME_NOW);
+            } else {
+                fillWindow(ctx);
+            }
+            flushIfPending(ctx);
+        }, think, TimeUnit.NANOSECONDS);
+    }
+
+    /**
+     * @param price the order's price, scaled like the ones {@link ExchangeProtocol#createOrder} takes
+     */
+    private void writeOrder(ChannelHandlerContext ctx, long clientId, WebSocketFrame order, long price, long encodeStartTime,
+                            long intendedSendTime) {
+        var encodedTime = System.nanoTime();
+        if (kernelTimestamping != null) {
+            if (!kernelTimestamping.onFrameWritten(false, clientId, order.content().readableBytes())) {
+                dropSample("TX offset", clientId);
+            }
+        }
+        ctx.write(order, ctx.voidPromise());
+        var writtenTime = System.nanoTime();
+        recordStage(LatencyStage.ENCODE, encodedTime - encodeStartTime);
+        var time = intendedSendTime == SEND_TIME_NOW ? writtenTime : intendedSendTime;
         //LOGGER.info("sending order: {}, time: {}", clientId, time);
-        orderSentTimeMap.put(clientId, time);
-        //LOGGER.info("sending pair, clientId: {}, {}", pair, clientId);
-        ch.flush();
-        orderResponseCount += 1;
+        if (!orderSentTimeMap.put(clientId, time, price)) {
+            dropSample("order", clientId);
+        }
+        addUnflushed(clientId, writtenTime, orderSentTimeMap);
+        inFlightPairs++;
+        latency.messageCount(++orderResponseCount);
     }
 }
@@ -18,9 +18,39 @@
 package com.aws.trading;
 
 import io.netty.buffer.ByteBuf;
+import io.netty.buffer.PooledByteBufAllocator;
 import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.WebSocketFrame;
 
 public interface ExchangeProtocol {
+    enum Encoding {
+        /**
+         * {@link ExchangeProtocolImpl}, JSON assembled from constant fragments.
+         */
+        JSON,
+        /**
+         * {@link TemplateExchangeProtocol}, pre-rendered JSON patched per order.
+         */
+        JSON_TEMPLATE,
+        /**
+         * {@link BinaryExchangeProtocol}, fixed layout little endian messages in binary frames.
+         */
+        BINARY
+    }
+
+    static ExchangeProtocol create(Encoding encoding) {
+        switch (encoding) {
+            case JSON:
+                return new ExchangeProtocolImpl(Config.DECIMAL_SCALES);
+            case JSON_TEMPLATE:
+                return new TemplateExchangeProtocol(PooledByteBufAllocator.DEFAULT, Config.COIN_PAIRS, Config.DECIMAL_SCALES);
+            case BINARY:
+                return new BinaryExchangeProtocol(PooledByteBufAllocator.DEFAULT, Config.COIN_PAIRS);
+            default:
+                throw new IllegalArgumentException("unsupported protocol encoding " + encoding);
+        }
+    }
+
     TextWebSocketFrame createBuyOrder(String pair, String clientId);
 
     ByteBuf createSellOrder(String pair, String clientId);
@@ -28,4 +58,41 @@ public interface ExchangeProtocol {
     ByteBuf createOrder(String pair, String type, String uuid, String side, String price, String qty);
 
     TextWebSocketFrame createCancelOrder(String pair, String clientid);
+
+    /**
+     * Writes the client id of the key straight into the order instead of going through a String.
+     */
+    WebSocketFrame createBuyOrder(String pair, ClientIdGenerator clientIds, long clientOrderId);
+
+    /**
+     * Order of the given type; price and amount are in units of the pair's last decimal place, see
+     * {@link DecimalScales}. Market orders carry the price but the venue ignores it.
+     */
+    WebSocketFrame createOrder(String pair, OrderType type, Side side, ClientIdGenerator clientIds, long clientOrderId, long price, long amount);
+
+    /**
+     * Good till cancelled limit order with integer price and amount.
+     */
+    default WebSocketFrame createLimitOrder(String pair, Side side, ClientIdGenerator clientIds, long clientOrderId, long price, long amount) {
+        return createOrder(pair, OrderType.LIMIT, side, clientIds, clientOrderId, price, amount);
+    }
+
+    /**
+     * Echoes the client id bytes of a response, which must still be readable while this is called.
+     */
+    WebSocketFrame createCancelOrder(String pair, AsciiView clientId);
+
+    /**
+     * Decoder for the venue's responses to the orders this protocol encodes.
+     */
+    default ResponseDecoder newResponseDecoder() {
+        return new InboundMessageParser();
+    }
+
+    /**
+     * Whether orders go out as binary frames, which is also how their responses come back.
+     */
+    default boolean isBinary() {
+        return false;
+    }
 }
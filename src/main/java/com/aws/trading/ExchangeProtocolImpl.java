@@ -18,6 +18,7 @@
 package com.aws.trading;
 
 import io.netty.buffer.ByteBuf;
+import io.netty.buffer.ByteBufAllocator;
 import io.netty.buffer.Unpooled;
 import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
 import io.netty.util.CharsetUtil;
@@ -25,6 +26,7 @@ import io.netty.util.internal.PlatformDependent;
 
 import java.nio.charset.StandardCharsets;
 import java.util.Base64;
+import java.util.HashMap;
 
 public class ExchangeProtocolImpl implements ExchangeProtocol {
     public static final byte[] AUTH_MSG_HEADER = "{\"type\":\"AUTHENTICATE\",\"api_token\":\"".getBytes(StandardCharsets.UTF_8);
@@ -47,6 +49,21 @@ public class ExchangeProtocolImpl implements ExchangeProtocol {
     final static byte[] CANCEL_ORDER_CLIENT_ID_END = "\",\"instrument_code\":\"".getBytes(StandardCharsets.UTF_8);
     final static byte[] MSG_END =    "\"}".getBytes(StandardCharsets.UTF_8);
     final static byte[] SUBSCRIBE_MSG = "{\"type\":\"SUBSCRIBE\",\"channels\":[{\"name\":\"ORDERS\"}]}".getBytes(StandardCharsets.UTF_8);
+    final static int ORDER_FIXED_LENGTH = HEADER.length + SYMBOL_END.length + CLIENT_ID_END.length + sellSide.length
+            + SIDE_END.length + TYPE_END.length + PRICE_END.length + AMOUNT_END.length + TIME_IN_FORCE_END.length;
+    final static int CANCEL_ORDER_FIXED_LENGTH = CANCEL_ORDER_HEADER.length + CANCEL_ORDER_CLIENT_ID_END.length + MSG_END.length;
+
+    private final ByteBufAllocator allocator = ByteBufAllocator.DEFAULT;
+    private final HashMap<String, byte[]> pairBytes = new HashMap<>();
+    private final DecimalScales scales;
+
+    public ExchangeProtocolImpl() {
+        this(DecimalScales.NONE);
+    }
+
+    public ExchangeProtocolImpl(DecimalScales scales) {
+        this.scales = scales;
+    }
 
     static byte[] randomBytes(int size) {
         byte[] bytes = new byte[size];
@@ -125,4 +142,44 @@ public class ExchangeProtocolImpl implements ExchangeProtocol {
         ));
     }
 
+    /**
+     * Buys at the default price and amount, written at the pair's {@link DecimalScales} like any other order.
+     */
+    public TextWebSocketFrame createBuyOrder(String pair, ClientIdGenerator clientIds, long clientOrderId) {
+        return createOrder(pair, OrderType.LIMIT, Side.BUY, clientIds, clientOrderId,
+                TemplateExchangeProtocol.DEFAULT_PRICE, TemplateExchangeProtocol.DEFAULT_AMOUNT);
+    }
+
+    public TextWebSocketFrame createOrder(String pair, OrderType type, Side side, ClientIdGenerator clientIds, long clientOrderId, long price, long amount) {
+        final byte[] symbol = pairBytes.computeIfAbsent(pair, p -> p.getBytes(StandardCharsets.UTF_8));
+        final int priceScale = scales.priceScale(pair);
+        final int amountScale = scales.amountScale(pair);
+        final ByteBuf buf = allocator.directBuffer(ORDER_FIXED_LENGTH + symbol.length + clientIds.length(clientOrderId)
+                + type.wireTypeBytes.length + type.wireTimeInForceBytes.length
+                + AsciiNumbers.decimalLength(price, priceScale) + AsciiNumbers.decimalLength(amount, amountScale));
+        buf.writeBytes(ExchangeProtocolImpl.HEADER)
+                .writeBytes(symbol).writeBytes(ExchangeProtocolImpl.SYMBOL_END);
+        clientIds.write(buf, clientOrderId);
+        buf.writeBytes(ExchangeProtocolImpl.CLIENT_ID_END)
+                .writeBytes(side.wireName).writeBytes(ExchangeProtocolImpl.SIDE_END)
+                .writeBytes(type.wireTypeBytes).writeBytes(ExchangeProtocolImpl.TYPE_END);
+        AsciiNumbers.writeDecimal(buf, price, priceScale);
+        buf.writeBytes(ExchangeProtocolImpl.PRICE_END);
+        AsciiNumbers.writeDecimal(buf, amount, amountScale);
+        buf.writeBytes(ExchangeProtocolImpl.AMOUNT_END)
+                .writeBytes(type.wireTimeInForceBytes).writeBytes(ExchangeProtocolImpl.TIME_IN_FORCE_END);
+        return new TextWebSocketFrame(buf);
+    }
+
+    public TextWebSocketFrame createCancelOrder(String pair, AsciiView clientId) {
+        final byte[] symbol = pairBytes.computeIfAbsent(pair, p -> p.getBytes(StandardCharsets.UTF_8));
+        final ByteBuf buf = allocator.directBuffer(CANCEL_ORDER_FIXED_LENGTH + symbol.length + clientId.length());
+        buf.writeBytes(ExchangeProtocolImpl.CANCEL_ORDER_HEADER);
+        clientId.copyTo(buf);
+        buf.writeBytes(ExchangeProtocolImpl.CANCEL_ORDER_CLIENT_ID_END)
+                .writeBytes(symbol)
+                .writeBytes(ExchangeProtocolImpl.MSG_END);
+        return new TextWebSocketFrame(buf);
+    }
+
 }
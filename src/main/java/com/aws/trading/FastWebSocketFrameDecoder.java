@@ -0,0 +1,128 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.channel.ChannelHandlerContext;
+import io.netty.handler.codec.ByteToMessageDecoder;
+import io.netty.handler.codec.TooLongFrameException;
+import io.netty.handler.codec.http.websocketx.BinaryWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.CloseWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.CorruptedWebSocketFrameException;
+import io.netty.handler.codec.http.websocketx.PingWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.PongWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
+
+import java.util.List;
+
+import static com.aws.trading.FastWebSocketFrameEncoder.*;
+
+/**
+ * Client side WebSocket decoder for the unmasked, unfragmented frames a server sends. The header is parsed in place
+ * and the payload of a frame with the bare opcode, text unless told otherwise, is passed on as a retained slice of
+ * the read buffer, so a frame that arrived in one read costs no copy and no frame object. The other data opcode and
+ * the control frames, which are rare, are still wrapped in Netty's frame classes.
+ */
+public final class FastWebSocketFrameDecoder extends ByteToMessageDecoder {
+    private final int maxFramePayloadLength;
+    private final int bareOpcode;
+
+    public FastWebSocketFrameDecoder(int maxFramePayloadLength) {
+        this(maxFramePayloadLength, OPCODE_TEXT);
+    }
+
+    /**
+     * @param bareOpcode {@link FastWebSocketFrameEncoder#OPCODE_TEXT} or {@link FastWebSocketFrameEncoder#OPCODE_BINARY}
+     */
+    public FastWebSocketFrameDecoder(int maxFramePayloadLength, int bareOpcode) {
+        if (bareOpcode != OPCODE_TEXT && bareOpcode != OPCODE_BINARY) {
+            throw new IllegalArgumentException("bare opcode must be text or binary, not " + bareOpcode);
+        }
+        this.maxFramePayloadLength = maxFramePayloadLength;
+        this.bareOpcode = bareOpcode;
+    }
+
+    @Override
+    protected void decode(ChannelHandlerContext ctx, ByteBuf in, List<Object> out) throws Exception {
+        final int readable = in.readableBytes();
+        if (readable < 2) {
+            return;
+        }
+        final int index = in.readerIndex();
+        final int b0 = in.getUnsignedByte(index);
+        final int b1 = in.getUnsignedByte(index + 1);
+        if ((b0 & 0x70) != 0) {
+            throw new CorruptedWebSocketFrameException("RSV bits set without a negotiated extension");
+        }
+        if ((b1 & 0x80) != 0) {
+            throw new CorruptedWebSocketFrameException("server frames must not be masked");
+        }
+        long length = b1 & 0x7F;
+        int headerLength = 2;
+        if (length == 126) {
+            if (readable < 4) {
+                return;
+            }
+            length = in.getUnsignedShort(index + 2);
+            headerLength = 4;
+        } else if (length == 127) {
+            if (readable < 10) {
+                return;
+            }
+            length = in.getLong(index + 2);
+            headerLength = 10;
+        }
+        if (length < 0 || length > maxFramePayloadLength) {
+            throw new TooLongFrameException("WebSocket frame payload of " + length + " bytes is over the limit of "
+                    + maxFramePayloadLength);
+        }
+        if (readable < headerLength + length) {
+            return;
+        }
+        final int payloadIndex = index + headerLength;
+        final int payloadLength = (int) length;
+        final int opcode = b0 & 0x0F;
+        if ((b0 & 0x80) == 0 || opcode == OPCODE_CONTINUATION) {
+            throw new CorruptedWebSocketFrameException("fragmented frames are not supported");
+        }
+        in.readerIndex(payloadIndex + payloadLength);
+        if (opcode == bareOpcode) {
+            out.add(in.retainedSlice(payloadIndex, payloadLength));
+            return;
+        }
+        switch (opcode) {
+            case OPCODE_TEXT:
+                out.add(new TextWebSocketFrame(true, 0, in.retainedSlice(payloadIndex, payloadLength)));
+                break;
+            case OPCODE_BINARY:
+                out.add(new BinaryWebSocketFrame(true, 0, in.retainedSlice(payloadIndex, payloadLength)));
+                break;
+            case OPCODE_CLOSE:
+                out.add(new CloseWebSocketFrame(true, 0, in.retainedSlice(payloadIndex, payloadLength)));
+                break;
+            case OPCODE_PING:
+                out.add(new PingWebSocketFrame(in.retainedSlice(payloadIndex, payloadLength)));
+                break;
+            case OPCODE_PONG:
+                out.add(new PongWebSocketFrame(in.retainedSlice(payloadIndex, payloadLength)));
+                break;
+            default:
+                throw new CorruptedWebSocketFrameException("unknown opcode " + opcode);
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.ByteBufHolder;
+import io.netty.channel.ChannelHandlerContext;
+import io.netty.handler.codec.MessageToByteEncoder;
+import io.netty.handler.codec.http.websocketx.BinaryWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.CloseWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.PingWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.PongWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.WebSocketFrame;
+
+import java.util.concurrent.ThreadLocalRandom;
+
+/**
+ * Client side WebSocket encoder for unfragmented frames. A plain {@link ByteBuf} is sent as a text frame, frames from
+ * the protocol are unwrapped. Header and masked payload go into one buffer sized up front, and the payload is masked
+ * eight bytes at a time with the frame's key widened to a long.
+ */
+public final class FastWebSocketFrameEncoder extends MessageToByteEncoder<Object> {
+    static final int OPCODE_CONTINUATION = 0x0;
+    static final int OPCODE_TEXT = 0x1;
+    static final int OPCODE_BINARY = 0x2;
+    static final int OPCODE_CLOSE = 0x8;
+    static final int OPCODE_PING = 0x9;
+    static final int OPCODE_PONG = 0xA;
+    private static final int FIN = 0x80;
+    private static final int MASK = 0x80;
+
+    public FastWebSocketFrameEncoder() {
+        super(true);
+    }
+
+    @Override
+    public boolean acceptOutboundMessage(Object msg) {
+        return msg instanceof ByteBuf || msg instanceof WebSocketFrame;
+    }
+
+    @Override
+    protected ByteBuf allocateBuffer(ChannelHandlerContext ctx, Object msg, boolean preferDirect) {
+        return ctx.alloc().directBuffer(frameLength(payload(msg).readableBytes()));
+    }
+
+    @Override
+    protected void encode(ChannelHandlerContext ctx, Object msg, ByteBuf out) {
+        final ByteBuf payload = payload(msg);
+        final int length = payload.readableBytes();
+        out.writeByte(FIN | opcode(msg));
+        if (length <= 125) {
+            out.writeByte(MASK | length);
+        } else if (length <= 0xFFFF) {
+            out.writeByte(MASK | 126);
+            out.writeShort(length);
+        } else {
+            out.writeByte(MASK | 127);
+            out.writeLong(length);
+        }
+        final int mask = ThreadLocalRandom.current().nextInt();
+        out.writeInt(mask);
+        mask(payload, payload.readerIndex(), length, mask, out);
+    }
+
+    /**
+     * Writes length bytes of src, starting at index, to out XORed with the masking key.
+     */
+    static void mask(ByteBuf src, int index, int length, int mask, ByteBuf out) {
+        final long longMask = ((long) mask << 32) | (mask & 0xFFFFFFFFL);
+        final int end = index + length;
+        int i = index;
+        for (; i + 8 <= end; i += 8) {
+            out.writeLong(src.getLong(i) ^ longMask);
+        }
+        if (i + 4 <= end) {
+            out.writeInt(src.getInt(i) ^ mask);
+            i += 4;
+        }
+        // whole words were consumed so far, the tail starts at the first key byte again
+        for (int shift = 24; i < end; i++, shift -= 8) {
+            out.writeByte(src.getByte(i) ^ (mask >>> shift));
+        }
+    }
+
+    static int frameLength(int payloadLength) {
+        final int extendedLength = payloadLength <= 125 ? 0 : payloadLength <= 0xFFFF ? 2 : 8;
+        return 2 + extendedLength + 4 + payloadLength;
+    }
+
+    private static ByteBuf payload(Object msg) {
+        return msg instanceof ByteBuf ? (ByteBuf) msg : ((ByteBufHolder) msg).content();
+    }
+
+    private static int opcode(Object msg) {
+        if (msg instanceof ByteBuf) {
+            return OPCODE_TEXT;
+        } else if (msg instanceof BinaryWebSocketFrame) {
+            return OPCODE_BINARY;
+        } else if (msg instanceof CloseWebSocketFrame) {
+            return OPCODE_CLOSE;
+        } else if (msg instanceof PingWebSocketFrame) {
+            return OPCODE_PING;
+        } else if (msg instanceof PongWebSocketFrame) {
+            return OPCODE_PONG;
+        }
+        return OPCODE_TEXT;
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+/**
+ * How order entry messages are delimited on the connection.
+ */
+public enum Framing {
+    /**
+     * WebSocket frames on an HTTP upgraded connection, as the venue speaks it.
+     */
+    WEBSOCKET,
+    /**
+     * A 4 byte big endian length followed by the message, on a plain TCP connection to TCP_PORT. There is no
+     * handshake, masking or HTTP, so this is a floor for what WebSocket framing costs.
+     */
+    TCP;
+
+    /**
+     * Bytes a client message with the given payload takes on the wire. For WebSocket that's a masked frame: 2 header
+     * bytes, the extended length and the 4 byte mask key.
+     */
+    public int wireLength(int payloadLength) {
+        if (this == TCP) {
+            return LengthPrefixedFrameEncoder.LENGTH_FIELD_LENGTH + payloadLength;
+        }
+        final int extendedLength = payloadLength <= 125 ? 0 : payloadLength <= 65535 ? 2 : 8;
+        return 2 + extendedLength + 4 + payloadLength;
+    }
+}
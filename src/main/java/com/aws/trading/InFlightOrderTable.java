@@ -0,0 +1,72 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+/**
+ * Sent timestamps of the orders and cancels that are waiting for a response, keyed by a numeric client order id.
+ * Implementations are used from a single event loop thread and must not allocate per operation.
+ */
+public interface InFlightOrderTable {
+    /**
+     * Returned by {@link #remove(long)} when there is no entry for the id.
+     */
+    long MISSING = Long.MIN_VALUE;
+
+    /**
+     * @return false if the table is full and the entry could not be stored
+     */
+    default boolean put(long clientOrderId, long sentTime) {
+        return put(clientOrderId, sentTime, MISSING);
+    }
+
+    /**
+     * Stores the entry with the price the order was sent at, which {@link #lastRemovedPrice()} hands back.
+     *
+     * @return false if the table is full and the entry could not be stored
+     */
+    boolean put(long clientOrderId, long sentTime, long price);
+
+    /**
+     * @return the sent time stored for the id, or {@link #MISSING}
+     */
+    long remove(long clientOrderId);
+
+    boolean contains(long clientOrderId);
+
+    /**
+     * Records when the frame of the entry was flushed.
+     *
+     * @return false if there is no entry for the id
+     */
+    boolean markFlushed(long clientOrderId, long flushTime);
+
+    /**
+     * @return flush time of the entry most recently removed, or 0 if it was not marked as flushed
+     */
+    long lastRemovedFlushTime();
+
+    /**
+     * @return price of the entry most recently removed, or {@link #MISSING} if it was stored without one or the last
+     * remove found no entry
+     */
+    long lastRemovedPrice();
+
+    int size();
+
+    void clear();
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Single pass scanner for the exchange's JSON messages. Instead of building a document it walks the top level object
+ * once and points the reusable views below at the few values the latency test needs. Nested objects and arrays are
+ * skipped, and nothing is allocated per message.
+ * The views point into the scanned buffer, so they must be consumed before that buffer is released.
+ */
+public final class InboundMessageParser implements ResponseDecoder {
+    private static final byte[] TYPE = "type".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] CLIENT_ID = "client_id".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] INSTRUMENT_CODE = "instrument_code".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] STATUS = "status".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] RECV_NS = "recv_ns".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] SEND_NS = "send_ns".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] PRICE = "price".getBytes(StandardCharsets.US_ASCII);
+
+    public final AsciiView type = new AsciiView();
+    public final AsciiView clientId = new AsciiView();
+    public final AsciiView instrumentCode = new AsciiView();
+    public final AsciiView status = new AsciiView();
+    public final AsciiView recvNs = new AsciiView();
+    public final AsciiView sendNs = new AsciiView();
+    public final AsciiView price = new AsciiView();
+    private MessageType messageType = MessageType.UNKNOWN;
+
+    /**
+     * Scans the readable bytes of the buffer without moving its reader index.
+     *
+     * @return false if the bytes are not a well-formed JSON object
+     */
+    @Override
+    public boolean parse(ByteBuf buf) {
+        type.reset();
+        clientId.reset();
+        instrumentCode.reset();
+        status.reset();
+        recvNs.reset();
+        sendNs.reset();
+        price.reset();
+        messageType = MessageType.UNKNOWN;
+
+        final int end = buf.writerIndex();
+        int i = skipWhitespace(buf, buf.readerIndex(), end);
+        if (i >= end || buf.getByte(i) != '{') {
+            return false;
+        }
+        i++;
+        while (true) {
+            i = skipWhitespace(buf, i, end);
+            if (i >= end) {
+                return false;
+            }
+            final byte b = buf.getByte(i);
+            if (b == '}') {
+                break;
+            }
+            if (b == ',') {
+                i++;
+                continue;
+            }
+            if (b != '"') {
+                return false;
+            }
+            final int keyStart = i + 1;
+            final int keyEnd = scanString(buf, keyStart, end);
+            if (keyEnd < 0) {
+                return false;
+            }
+            i = skipWhitespace(buf, keyEnd + 1, end);
+            if (i >= end || buf.getByte(i) != ':') {
+                return false;
+            }
+            i = skipWhitespace(buf, i + 1, end);
+            if (i >= end) {
+                return false;
+            }
+            final AsciiView target = fieldFor(buf, keyStart, keyEnd - keyStart);
+            if (buf.getByte(i) == '"') {
+                final int valueEnd = scanString(buf, i + 1, end);
+                if (valueEnd < 0) {
+                    return false;
+                }
+                if (target != null) {
+                    target.wrap(buf, i + 1, valueEnd - i - 1);
+                }
+                i = valueEnd + 1;
+            } else {
+                final int valueEnd = skipValue(buf, i, end);
+                if (valueEnd < 0) {
+                    return false;
+                }
+                if (target != null) {
+                    target.wrap(buf, i, valueEnd - i);
+                }
+                i = valueEnd;
+            }
+        }
+        messageType = MessageType.of(type);
+        return true;
+    }
+
+    @Override
+    public MessageType messageType() {
+        return messageType;
+    }
+
+    @Override
+    public AsciiView clientId() {
+        return clientId;
+    }
+
+    @Override
+    public AsciiView instrumentCode() {
+        return instrumentCode;
+    }
+
+    @Override
+    public OrderStatus status() {
+        return messageType == MessageType.DONE ? OrderStatus.of(status) : OrderStatus.UNKNOWN;
+    }
+
+    @Override
+    public long clientOrderId(ClientIdGenerator clientIds) {
+        return clientIds.parse(clientId);
+    }
+
+    @Override
+    public long serverReceiveNanos() {
+        return timestamp(recvNs);
+    }
+
+    @Override
+    public long serverSendNanos() {
+        return timestamp(sendNs);
+    }
+
+    @Override
+    public long price(int scale) {
+        return decimal(price, scale);
+    }
+
+    private static long decimal(AsciiView view, int scale) {
+        if (!view.isPresent()) {
+            return NO_VALUE;
+        }
+        final long value = AsciiNumbers.parseDecimal(view, scale);
+        return value == AsciiNumbers.INVALID ? NO_VALUE : value;
+    }
+
+    private static long timestamp(AsciiView view) {
+        if (!view.isPresent()) {
+            return NO_TIMESTAMP;
+        }
+        final long nanos = AsciiNumbers.parseLong(view);
+        return nanos == AsciiNumbers.INVALID ? NO_TIMESTAMP : nanos;
+    }
+
+    private AsciiView fieldFor(ByteBuf buf, int keyStart, int keyLength) {
+        if (matches(buf, keyStart, keyLength, TYPE)) {
+            return type;
+        } else if (matches(buf, keyStart, keyLength, CLIENT_ID)) {
+            return clientId;
+        } else if (matches(buf, keyStart, keyLength, INSTRUMENT_CODE)) {
+            return instrumentCode;
+        } else if (matches(buf, keyStart, keyLength, STATUS)) {
+            return status;
+        } else if (matches(buf, keyStart, keyLength, RECV_NS)) {
+            return recvNs;
+        } else if (matches(buf, keyStart, keyLength, SEND_NS)) {
+            return sendNs;
+        } else if (matches(buf, keyStart, keyLength, PRICE)) {
+            return price;
+        }
+        return null;
+    }
+
+    private static boolean matches(ByteBuf buf, int start, int length, byte[] key) {
+        if (length != key.length) {
+            return false;
+        }
+        for (int i = 0; i < length; i++) {
+            if (buf.getByte(start + i) != key[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private static int skipWhitespace(ByteBuf buf, int i, int end) {
+        while (i < end) {
+            final byte b = buf.getByte(i);
+            if (b != ' ' && b != '\n' && b != '\r' && b != '\t') {
+                break;
+            }
+            i++;
+        }
+        return i;
+    }
+
+    /**
+     * @return index of the closing quote of the string starting at {@code i}, or -1 if it is not terminated
+     */
+    private static int scanString(ByteBuf buf, int i, int end) {
+        while (i < end) {
+            final byte b = buf.getByte(i);
+            if (b == '"') {
+                return i;
+            }
+            i += b == '\\' ? 2 : 1;
+        }
+        return -1;
+    }
+
+    /**
+     * Skips a number, literal, object or array value.
+     *
+     * @return index of the first byte after the value, or -1 if the value is not terminated
+     */
+    private static int skipValue(ByteBuf buf, int i, int end) {
+        int depth = 0;
+        while (i < end) {
+            final byte b = buf.getByte(i);
+            if (b == '"') {
+                i = scanString(buf, i + 1, end);
+                if (i < 0) {
+                    return -1;
+                }
+            } else if (b == '{' || b == '[') {
+                depth++;
+            } else if (b == '}' || b == ']') {
+                if (depth == 0) {
+                    return i;
+                }
+                if (--depth == 0) {
+                    return i + 1;
+                }
+            } else if (depth == 0 && (b == ',' || b == ' ' || b == '\n' || b == '\r' || b == '\t')) {
+                return i;
+            }
+            i++;
+        }
+        return -1;
+    }
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.channel.Channel;
+import io.netty.channel.unix.UnixChannel;
+import org.apache.logging.log4j.LogManager;
+import org.apache.logging.log4j.Logger;
+
+/**
+ * Kernel TX timestamps for one connection, read from the socket error queue through a small JNI shim
+ * (src/main/native/kernel_timestamping.c). With SOF_TIMESTAMPING_OPT_ID the kernel keys every timestamp on a TCP
+ * socket by the offset of the last byte of the send it belongs to, so the handler reports how many bytes each frame
+ * puts on the wire and a frame's timestamp is the first one whose key reaches the frame's last byte.
+ * <p>
+ * Netty's epoll and io_uring transports read without a control buffer, so RX timestamps never reach user space; the
+ * receive side of the wire-to-wire measurement is the first read of the response in the pipeline instead. Hardware
+ * stamps are in the NIC's clock and are only comparable with it when that clock is synchronised to the system clock,
+ * e.g. with phc2sys.
+ * <p>
+ * The error queue is drained when a response arrives rather than when the stamp does, so every stamp reports the
+ * socket readable until then. The handler therefore only enables it on edge triggered epoll, which wakes the event loop
+ * once per stamp, an extra wake-up per frame sent; level triggered epoll would spin and io_uring's polls fire again
+ * the same way.
+ * <p>
+ * Not thread safe, all methods are called from the handler's event loop.
+ */
+public final class KernelTimestamping {
+    private static final Logger LOGGER = LogManager.getLogger(KernelTimestamping.class);
+
+    public enum Mode {
+        NONE, SOFTWARE, HARDWARE
+    }
+
+    private static final int SOF_TIMESTAMPING_TX_HARDWARE = 1;
+    private static final int SOF_TIMESTAMPING_TX_SOFTWARE = 1 << 1;
+    private static final int SOF_TIMESTAMPING_SOFTWARE = 1 << 4;
+    private static final int SOF_TIMESTAMPING_RAW_HARDWARE = 1 << 6;
+    private static final int SOF_TIMESTAMPING_OPT_ID = 1 << 7;
+    private static final int SOF_TIMESTAMPING_OPT_TSONLY = 1 << 11;
+    private static final int SCM_TSTAMP_SND = 0;
+    private static final int DRAIN_BATCH = 64;
+    private static final int TX_RING_CAPACITY = 1024;
+    private static final int TX_RING_MASK = TX_RING_CAPACITY - 1;
+    private static final boolean LIBRARY_LOADED = loadLibrary();
+
+    private final int flags;
+    private final Framing framing;
+    private final InFlightOrderTable orderEndOffsets;
+    private final InFlightOrderTable cancelEndOffsets;
+    private final long[] drained = new long[3 * DRAIN_BATCH];
+    private final int[] txKeys = new int[TX_RING_CAPACITY];
+    private final long[] txTimes = new long[TX_RING_CAPACITY];
+    private int txHead;
+    private int txCount;
+    private int fd = -1;
+    private long bytesSent;
+
+    public KernelTimestamping(Mode mode, Framing framing, int capacity) {
+        if (mode == Mode.NONE) {
+            throw new IllegalArgumentException("kernel timestamping mode must be SOFTWARE or HARDWARE");
+        }
+        this.flags = SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY | (mode == Mode.HARDWARE
+                ? SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+                : SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE);
+        this.framing = framing;
+        this.orderEndOffsets = new OpenAddressingInFlightTable(capacity);
+        this.cancelEndOffsets = new OpenAddressingInFlightTable(capacity);
+    }
+
+    /**
+     * Turns timestamping on for the channel's socket. Keys count from the oldest unacknowledged byte at this point, so
+     * it has to be called while nothing is in flight, e.g. right after the WebSocket handshake response arrives
+     * or the TCP connection is established.
+     *
+     * @return false if the transport, the native library or the kernel doesn't support it
+     */
+    public boolean enable(Channel channel) {
+        if (!LIBRARY_LOADED) {
+            LOGGER.error("kerneltimestamping native library is not on java.library.path, kernel timestamping is off");
+            return false;
+        }
+        if (!(channel instanceof UnixChannel)) {
+            LOGGER.error("kernel timestamping needs the epoll transport, {} is not supported",
+                    channel.getClass().getSimpleName());
+            return false;
+        }
+        final int channelFd = ((UnixChannel) channel).fd().intValue();
+        final int result = enable0(channelFd, flags);
+        if (result != 0) {
+            LOGGER.error("setsockopt(SO_TIMESTAMPING) failed with errno {}, kernel timestamping is off", -result);
+            return false;
+        }
+        this.fd = channelFd;
+        this.bytesSent = 0;
+        return true;
+    }
+
+    /**
+     * Accounts for a frame the handler writes that isn't an order or a cancel.
+     */
+    public void onFrameWritten(int payloadLength) {
+        bytesSent += framing.wireLength(payloadLength);
+    }
+
+    /**
+     * @return false if the frame's offset didn't fit, so the frame won't get a TX timestamp
+     */
+    public boolean onFrameWritten(boolean cancel, long clientOrderId, int payloadLength) {
+        bytesSent += framing.wireLength(payloadLength);
+        return (cancel ? cancelEndOffsets : orderEndOffsets).put(clientOrderId, bytesSent);
+    }
+
+    /**
+     * Takes the TX timestamp of a frame whose response has arrived.
+     *
+     * @return the timestamp on the {@link System#nanoTime()} timeline, or {@link InFlightOrderTable#MISSING}
+     */
+    public long takeTxTime(boolean cancel, long clientOrderId) {
+        final long endOffset = (cancel ? cancelEndOffsets : orderEndOffsets).remove(clientOrderId);
+        if (endOffset == InFlightOrderTable.MISSING) {
+            return InFlightOrderTable.MISSING;
+        }
+        drain();
+        final int lastByte = (int) (endOffset - 1);
+        while (txCount > 0) {
+            // keys are 32 bit and wrap, entries behind the frame's last byte belong to frames already answered
+            if (txKeys[txHead] - lastByte >= 0) {
+                return txTimes[txHead];
+            }
+            txHead = (txHead + 1) & TX_RING_MASK;
+            txCount--;
+        }
+        return InFlightOrderTable.MISSING;
+    }
+
+    private void drain() {
+        int count;
+        do {
+            count = readTxTimestamps0(fd, drained, DRAIN_BATCH);
+            if (count <= 0) {
+                return;
+            }
+            // the kernel stamps in CLOCK_REALTIME, move them onto the nanoTime timeline the rest of the stages use
+            final long realtimeOffset = realtimeNanos0() - System.nanoTime();
+            for (int i = 0; i < count; i++) {
+                if (drained[3 * i + 1] == SCM_TSTAMP_SND) {
+                    append((int) drained[3 * i], drained[3 * i + 2] - realtimeOffset);
+                }
+            }
+        } while (count == DRAIN_BATCH);
+    }
+
+    private void append(int key, long txTime) {
+        if (txCount == TX_RING_CAPACITY) {
+            txHead = (txHead + 1) & TX_RING_MASK;
+            txCount--;
+        }
+        final int slot = (txHead + txCount) & TX_RING_MASK;
+        txKeys[slot] = key;
+        txTimes[slot] = txTime;
+        txCount++;
+    }
+
+
+    private static boolean loadLibrary() {
+        try {
+            System.loadLibrary("kerneltimestamping");
+            return true;
+        } catch (UnsatisfiedLinkError e) {
+            return false;
+        }
+    }
+
+    private static native int enable0(int fd, int flags);
+
+    private static native int readTxTimestamps0(int fd, long[] out, int maxEntries);
+
+    private static native long realtimeNanos0();
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import org.HdrHistogram.Histogram;
+import org.HdrHistogram.HistogramLogWriter;
+import org.HdrHistogram.SingleWriterRecorder;
+import org.apache.logging.log4j.LogManager;
+import org.apache.logging.log4j.Logger;
+
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.PrintStream;
+import java.util.Arrays;
+import java.util.LinkedHashMap;
+import java.util.concurrent.CopyOnWriteArrayList;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicLong;
+
+import static com.aws.trading.Config.*;
+
+/**
+ * Collects the latencies of all connections on its own thread. Every connection records into its own
+ * {@link SingleWriterRecorder}s and publishes its message count; the aggregator harvests their interval histograms
+ * every AGGREGATION_INTERVAL_MS, so the event loops never wait on each other or on the reporting. Once the warm-up is
+ * over a report is logged and appended to the histogram log for every REPORT_SIZE messages.
+ */
+public final class LatencyAggregator {
+    private static final Logger LOGGER = LogManager.getLogger(LatencyAggregator.class);
+
+    private final CopyOnWriteArrayList<Connection> connections = new CopyOnWriteArrayList<>();
+    private final ScheduledExecutorService executor = Executors.newSingleThreadScheduledExecutor(r -> {
+        final Thread thread = new Thread(r, "latency-aggregator");
+        thread.setDaemon(true);
+        return thread;
+    });
+    private final Histogram histogram = new Histogram(Long.MAX_VALUE, 2);
+    private final Histogram[] stageHistograms = LatencyStage.newHistograms();
+    private final long warmupMessages;
+    private final long reportSize;
+    private long nextReportAt;
+    private long lastMessageCount;
+    private long testStartTime;
+    private long histogramStartTime;
+
+    public LatencyAggregator(long warmupMessages, long reportSize) {
+        this.warmupMessages = warmupMessages;
+        this.reportSize = reportSize;
+        this.nextReportAt = warmupMessages + reportSize;
+    }
+
+    /**
+     * Registers a connection, whose recorders must then only be written by that connection's event loop.
+     */
+    public Connection register() {
+        final Connection connection = new Connection();
+        connections.add(connection);
+        return connection;
+    }
+
+    public void start() {
+        testStartTime = System.nanoTime();
+        histogramStartTime = testStartTime;
+        executor.scheduleAtFixedRate(this::harvest, AGGREGATION_INTERVAL_MS, AGGREGATION_INTERVAL_MS, TimeUnit.MILLISECONDS);
+    }
+
+    public void stop() throws InterruptedException {
+        executor.shutdown();
+        executor.awaitTermination(1, TimeUnit.SECONDS);
+    }
+
+    private void harvest() {
+        long messageCount = 0;
+        for (Connection connection : connections) {
+            messageCount += connection.messageCount.get();
+        }
+        // intervals are always taken so that warm-up samples don't leak into the first report
+        final boolean warmedUp = messageCount >= warmupMessages;
+        for (Connection connection : connections) {
+            connection.harvest(warmedUp ? histogram : null, warmedUp ? stageHistograms : null);
+        }
+        if (!warmedUp) {
+            if (messageCount != lastMessageCount) {
+                LOGGER.info("warming up... - message count: {}", messageCount);
+            }
+        } else if (messageCount >= nextReportAt) {
+            report(messageCount);
+            while (nextReportAt <= messageCount) {
+                nextReportAt += reportSize;
+            }
+        }
+        lastMessageCount = messageCount;
+    }
+
+    private void report(long messageCount) {
+        final long currentTime = System.nanoTime();
+        final long executionTime = currentTime - testStartTime;
+        var executionTimeStr = LatencyTools.formatNanos(executionTime);
+        var messagePerSecond = messageCount / Math.max(1, TimeUnit.SECONDS.convert(executionTime, TimeUnit.NANOSECONDS));
+        var logMsg = "\nTest Execution Time: {}s \n Transport: {} \n Framing: {} \n Event Loop Layout: {} \n Load Mode: {} \n Number of messages: {} \n Message Per Second: {} \n Dropped samples: {} \n Percentiles: {} \n Stages: \n{}";
+
+        try (PrintStream histogramLogFile = getLogFile()) {
+            saveHistogramToFile(currentTime, histogramLogFile);
+            histogramStartTime = currentTime;
+        } catch (IOException e) {
+            LOGGER.error(e);
+        }
+
+        LinkedHashMap<String, String> latencyReport = LatencyTools.createLatencyReport(histogram);
+        LOGGER.info(logMsg,
+                executionTimeStr, TRANSPORT.description(), FRAMING + " / " + PROTOCOL_ENCODING, eventLoopLayoutDescription(), loadModeDescription(), messageCount, messagePerSecond,
+                droppedSamples(),
+                LatencyTools.toJSON(latencyReport), LatencyTools.toTable(LatencyTools.createStageReport(stageHistograms))
+        );
+
+        histogram.reset();
+        for (Histogram stageHistogram : stageHistograms) {
+            stageHistogram.reset();
+        }
+    }
+
+    private long droppedSamples() {
+        long droppedSamples = 0;
+        for (Connection connection : connections) {
+            droppedSamples += connection.droppedSamples.get();
+        }
+        return droppedSamples;
+    }
+
+    private static String eventLoopLayoutDescription() {
+        return CONNECTION_LOOPS.length > 0
+                ? EVENT_LOOP_LAYOUT + ", connection loops " + Arrays.toString(CONNECTION_LOOPS)
+                : EVENT_LOOP_LAYOUT.toString();
+    }
+
+    private static String loadModeDescription() {
+        if (LOAD_MODE == LoadMode.REPLAY) {
+            return LOAD_MODE + " of " + REPLAY_FILE;
+        }
+        final String scenario = SCENARIO_FILE.isEmpty() ? "" : ", scenario " + SCENARIO_FILE;
+        return TARGET_RATE_PER_CONNECTION > 0
+                ? LOAD_MODE + " @ " + TARGET_RATE_PER_CONNECTION + " orders/s per connection" + scenario
+                : LOAD_MODE + scenario;
+    }
+
+    private void saveHistogramToFile(long currentTime, PrintStream log) {
+        var histogramLogWriter = new HistogramLogWriter(log);
+        histogramLogWriter.outputComment("[Logged with " + "Exchange Client 0.0.1" + "]");
+        histogramLogWriter.outputLogFormatVersion();
+        histogramLogWriter.outputStartTime(TimeUnit.MILLISECONDS.convert(currentTime, TimeUnit.NANOSECONDS));
+        histogramLogWriter.setBaseTime(TimeUnit.MILLISECONDS.convert(histogramStartTime, TimeUnit.NANOSECONDS));
+        histogramLogWriter.outputLegend();
+        histogramLogWriter.outputIntervalHistogram(histogram);
+        for (Histogram stageHistogram : stageHistograms) {
+            histogramLogWriter.outputIntervalHistogram(stageHistogram);
+        }
+    }
+
+    private static PrintStream getLogFile() throws IOException {
+        return new PrintStream(new FileOutputStream("./histogram.hlog", true), false);
+    }
+
+    /**
+     * The recorders of one connection. Written by the connection's event loop, harvested by the aggregator thread.
+     */
+    public static final class Connection {
+        private final SingleWriterRecorder roundTrips = new SingleWriterRecorder(Long.MAX_VALUE, 2);
+        private final SingleWriterRecorder[] stages = LatencyStage.newRecorders();
+        private final AtomicLong messageCount = new AtomicLong();
+        private final AtomicLong droppedSamples = new AtomicLong();
+        private Histogram roundTripInterval;
+        private final Histogram[] stageIntervals = new Histogram[LatencyStage.count()];
+
+        private Connection() {
+        }
+
+        public SingleWriterRecorder roundTrips() {
+            return roundTrips;
+        }
+
+        public SingleWriterRecorder[] stages() {
+            return stages;
+        }
+
+        /**
+         * Publishes the number of messages the connection has sent so far.
+         */
+        public void messageCount(long count) {
+            messageCount.lazySet(count);
+        }
+
+        /**
+         * Publishes the number of responses the connection couldn't measure because an in-flight table was full.
+         */
+        public void droppedSamples(long count) {
+            droppedSamples.lazySet(count);
+        }
+
+        /**
+         * Swaps out the interval histograms and adds them into the totals, or drops them if the totals are null.
+         */
+        private void harvest(Histogram roundTripTotal, Histogram[] stageTotals) {
+            roundTripInterval = roundTrips.getIntervalHistogram(roundTripInterval);
+            if (roundTripTotal != null) {
+                roundTripTotal.add(roundTripInterval);
+            }
+            for (int i = 0; i < stages.length; i++) {
+                stageIntervals[i] = stages[i].getIntervalHistogram(stageIntervals[i]);
+                if (stageTotals != null) {
+                    stageTotals[i].add(stageIntervals[i]);
+                }
+            }
+        }
+    }
+}
@@ -25,6 +25,8 @@ import org.apache.logging.log4j.Logger;
 import java.io.FileInputStream;
 import java.io.IOException;
 import java.nio.file.Path;
+import java.util.LinkedHashMap;
+import java.util.TreeMap;
 
 import static com.aws.trading.Main.printHelpMessage;
 
@@ -38,22 +40,49 @@ public class LatencyReport {
         }
         try {
             //read path to histogram file from args and load it
-            var path = Path.of(args[1]);
-            LOGGER.info("loading histogram from file {}", path.toFile());
-            HistogramLogReader logReader = new HistogramLogReader(new FileInputStream(path.toFile()));
-            Histogram histogram = null;
-            while (logReader.hasNext()){
-                Histogram iter = (Histogram) logReader.nextIntervalHistogram();
-                if(null == histogram){
-                    histogram = iter;
-                }else{
-                    histogram.add(iter);
-                }
-            }
-            assert histogram != null;
+            final TreeMap<LatencyStage, Histogram> stages = new TreeMap<>();
+            Histogram histogram = readHistograms(Path.of(args[1]), stages);
             LOGGER.info("Percentiles: \n {}", LatencyTools.createLatencyReportJson(histogram));
+            if (!stages.isEmpty()) {
+                LOGGER.info("Stages: \n{}", LatencyTools.toTable(
+                        LatencyTools.createStageReport(stages.values().toArray(new Histogram[0]))));
+            }
+            if (args.length > 2) {
+                // a second file is the baseline the first is compared with, e.g. SPLIT against SINGLE layout
+                Histogram baseline = readHistograms(Path.of(args[2]), new TreeMap<>());
+                final LinkedHashMap<String, LinkedHashMap<String, String>> rows = new LinkedHashMap<>();
+                rows.put("baseline", LatencyTools.createLatencyReport(baseline));
+                rows.put("run", LatencyTools.createLatencyReport(histogram));
+                rows.put("difference", LatencyTools.createLatencyDifference(histogram, baseline));
+                LOGGER.info("Compared with {}: \n{}", args[2], LatencyTools.toTable(rows));
+            }
         } catch (IOException e) {
             LOGGER.error(e);
         }
     }
+
+    /**
+     * Merges the round trip intervals of a histogram log and collects the stage intervals into stages.
+     */
+    private static Histogram readHistograms(Path path, TreeMap<LatencyStage, Histogram> stages) throws IOException {
+        LOGGER.info("loading histogram from file {}", path.toFile());
+        HistogramLogReader logReader = new HistogramLogReader(new FileInputStream(path.toFile()));
+        Histogram histogram = null;
+        // untagged intervals are round trips, tagged ones belong to a LatencyStage
+        while (logReader.hasNext()){
+            Histogram iter = (Histogram) logReader.nextIntervalHistogram();
+            if (iter.getTag() != null) {
+                stages.merge(LatencyStage.valueOf(iter.getTag()), iter, (a, b) -> {
+                    a.add(b);
+                    return a;
+                });
+            } else if(null == histogram){
+                histogram = iter;
+            }else{
+                histogram.add(iter);
+            }
+        }
+        assert histogram != null;
+        return histogram;
+    }
 }
@@ -0,0 +1,100 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import org.HdrHistogram.Histogram;
+import org.HdrHistogram.SingleWriterRecorder;
+
+/**
+ * Segments of an order's round trip, each tracked in its own histogram so that a regression can be attributed to the
+ * client, the kernel and network, or the venue.
+ */
+public enum LatencyStage {
+    /**
+     * Building the frame in the {@link ExchangeProtocol}.
+     */
+    ENCODE,
+    /**
+     * From the frame being written to the pipeline until the flush that carries it returns. With
+     * {@link EventLoopLayout#SPLIT} the handler's flush only queues a task on the connection's netty-io loop, so this is
+     * the time until the flush is handed over, not until the frame reaches the socket.
+     */
+    WRITE,
+    /**
+     * From the flush returning until the response's bytes are first read in the pipeline: kernel TX, wire, venue,
+     * wire and kernel RX. With {@link EventLoopLayout#SPLIT} it also includes the flush waiting for and running on the
+     * netty-io loop.
+     */
+    NETWORK,
+    /**
+     * From the kernel's TX timestamp of the send that carried the frame until the response's bytes are first read in
+     * the pipeline. Only recorded when KERNEL_TIMESTAMPING is enabled.
+     */
+    WIRE,
+    /**
+     * Time the venue held the order, from the recv_ns and send_ns its response echoes. Only recorded when the venue
+     * sends them, as the mock server does.
+     */
+    SERVER,
+    /**
+     * Estimated one-way network latency: half of NETWORK, or of the round trip when NETWORK isn't known, after taking
+     * out SERVER. Assumes both directions take as long.
+     */
+    ONE_WAY,
+    /**
+     * From the first read of the response until it reaches the latency test handler: WebSocket decoding and, with
+     * a separate worker group, the thread hand-off.
+     */
+    INBOUND,
+    /**
+     * Parsing the response in the handler.
+     */
+    DECODE,
+    /**
+     * Deflating an outbound or inflating an inbound frame with permessage-deflate. Only recorded when WS_DEFLATE is
+     * enabled and the venue accepted it.
+     */
+    COMPRESSION;
+
+    private static final LatencyStage[] STAGES = values();
+
+    public static SingleWriterRecorder[] newRecorders() {
+        final SingleWriterRecorder[] recorders = new SingleWriterRecorder[STAGES.length];
+        for (int i = 0; i < recorders.length; i++) {
+            recorders[i] = new SingleWriterRecorder(Long.MAX_VALUE, 2);
+        }
+        return recorders;
+    }
+
+    public static Histogram[] newHistograms() {
+        final Histogram[] histograms = new Histogram[STAGES.length];
+        for (int i = 0; i < histograms.length; i++) {
+            histograms[i] = new Histogram(Long.MAX_VALUE, 2);
+            histograms[i].setTag(STAGES[i].name());
+        }
+        return histograms;
+    }
+
+    public static LatencyStage at(int ordinal) {
+        return STAGES[ordinal];
+    }
+
+    public static int count() {
+        return STAGES.length;
+    }
+}
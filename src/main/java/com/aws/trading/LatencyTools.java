@@ -39,6 +39,55 @@ public final class LatencyTools {
         return fmt;
     }
 
+    /**
+     * Percentiles of run minus those of baseline, negative when the run is faster.
+     */
+    public static LinkedHashMap<String, String> createLatencyDifference(Histogram run, Histogram baseline) {
+        final LinkedHashMap<String, String> fmt = new LinkedHashMap<>();
+        Arrays.stream(PERCENTILES).forEach(p ->
+                fmt.put(p + "%", formatNanosDifference(run.getValueAtPercentile(p) - baseline.getValueAtPercentile(p)))
+        );
+        fmt.put("W", formatNanosDifference(run.getMaxValue() - baseline.getMaxValue()));
+        return fmt;
+    }
+
+    public static String formatNanosDifference(long ns) {
+        return (ns < 0 ? "-" : "+") + formatNanos(Math.abs(ns));
+    }
+
+    /**
+     * One row of percentiles per stage, in {@link LatencyStage} order. Histograms are matched to stages by tag.
+     */
+    public static LinkedHashMap<String, LinkedHashMap<String, String>> createStageReport(Histogram[] stageHistograms) {
+        final LinkedHashMap<String, LinkedHashMap<String, String>> rows = new LinkedHashMap<>();
+        for (Histogram histogram : stageHistograms) {
+            rows.put(histogram.getTag(), createLatencyReport(histogram));
+        }
+        return rows;
+    }
+
+    /**
+     * Lays rows of reports with the same keys out side by side, keys as column headers.
+     */
+    public static String toTable(LinkedHashMap<String, LinkedHashMap<String, String>> rows) {
+        final int nameWidth = rows.keySet().stream().mapToInt(String::length).max().orElse(0) + 2;
+        final String nameFormat = "%-" + nameWidth + "s";
+        final StringBuilder sb = new StringBuilder();
+        boolean header = true;
+        for (var row : rows.entrySet()) {
+            if (header) {
+                sb.append(String.format(nameFormat, ""));
+                row.getValue().keySet().forEach(k -> sb.append(String.format("%10s", k)));
+                sb.append("\n");
+                header = false;
+            }
+            sb.append(String.format(nameFormat, row.getKey()));
+            row.getValue().values().forEach(v -> sb.append(String.format("%10s", v)));
+            sb.append("\n");
+        }
+        return sb.toString();
+    }
+
     public static String toJSON(LinkedHashMap<String, String> fmt){
         return JSON.toJSONString(fmt, JSONWriter.Feature.PrettyFormat);
     }
@@ -0,0 +1,64 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.ByteBufHolder;
+import io.netty.channel.ChannelHandler;
+import io.netty.channel.ChannelHandlerContext;
+import io.netty.handler.codec.LengthFieldBasedFrameDecoder;
+import io.netty.handler.codec.MessageToMessageEncoder;
+import io.netty.handler.codec.http.websocketx.BinaryWebSocketFrame;
+import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
+
+import java.util.List;
+
+/**
+ * Writes the payload of the data frames and buffers the handler produces with a 4 byte length in front of it, see
+ * {@link Framing#TCP}. The payload isn't copied: the length goes out in its own small buffer and both are written
+ * with one gathering write. Inbound messages are split by the {@link LengthFieldBasedFrameDecoder} from
+ * {@link #newDecoder(int)}.
+ */
+@ChannelHandler.Sharable
+public final class LengthPrefixedFrameEncoder extends MessageToMessageEncoder<Object> {
+    public static final int LENGTH_FIELD_LENGTH = 4;
+    public static final LengthPrefixedFrameEncoder INSTANCE = new LengthPrefixedFrameEncoder();
+
+    private LengthPrefixedFrameEncoder() {
+    }
+
+    /**
+     * Decoder for the messages the server sends, passed on as retained slices of the read buffer without the length.
+     */
+    public static LengthFieldBasedFrameDecoder newDecoder(int maxFrameLength) {
+        return new LengthFieldBasedFrameDecoder(maxFrameLength + LENGTH_FIELD_LENGTH,
+                0, LENGTH_FIELD_LENGTH, 0, LENGTH_FIELD_LENGTH);
+    }
+
+    @Override
+    public boolean acceptOutboundMessage(Object msg) {
+        return msg instanceof ByteBuf || msg instanceof TextWebSocketFrame || msg instanceof BinaryWebSocketFrame;
+    }
+
+    @Override
+    protected void encode(ChannelHandlerContext ctx, Object msg, List<Object> out) {
+        final ByteBuf payload = msg instanceof ByteBuf ? (ByteBuf) msg : ((ByteBufHolder) msg).content();
+        out.add(ctx.alloc().directBuffer(LENGTH_FIELD_LENGTH).writeInt(payload.readableBytes()));
+        out.add(payload.retain());
+    }
+}
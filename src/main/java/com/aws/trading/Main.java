@@ -33,6 +33,8 @@ public class Main {
             RoundTripLatencyTester.main(args);
         } else if ("latency-report".equals(command)) {
             LatencyReport.main(args);
+        } else if ("replay-convert".equals(command)) {
+            ReplayFile.main(args);
         } else if ("help".equals(command)) {
             printHelpMessage();
         } else {
@@ -47,7 +49,10 @@ public class Main {
         System.out.println("latency-test: run latency test");
         System.out.println("latency-report: print latency report");
         System.out.println("<args> for latency-report:");
-        System.out.println("<path to latency report file>");
+        System.out.println("<path to latency report file> [<path to baseline latency report file>]");
+        System.out.println("replay-convert: convert a CSV of orders into a REPLAY_FILE");
+        System.out.println("<args> for replay-convert:");
+        System.out.println("<path to CSV file> <path to replay file>");
         System.out.println("help: print this message");
         System.out.println("exit: exit the program");
     }
@@ -0,0 +1,179 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import java.util.Arrays;
+
+/**
+ * Preallocated open addressing table with linear probing. Keys, timestamps and prices live in parallel primitive arrays
+ * so a lookup touches one or two cache lines and nothing is boxed. A slot is occupied only while its generation tag
+ * equals the table's current generation, which makes {@link #clear()} O(1). Removal shifts the following entries back
+ * instead of leaving tombstones, so probe sequences stay short on a table that constantly churns.
+ */
+public final class OpenAddressingInFlightTable implements InFlightOrderTable {
+    private final long[] keys;
+    private final long[] sentTimes;
+    private final long[] flushTimes;
+    private final long[] prices;
+    private final int[] generations;
+    private final int mask;
+    private final int maxSize;
+    private int generation = 1;
+    private int size;
+    private long lastRemovedFlushTime;
+    private long lastRemovedPrice = MISSING;
+
+    /**
+     * @param maxInFlight maximum number of entries; the table keeps its load factor at or below one half
+     */
+    public OpenAddressingInFlightTable(int maxInFlight) {
+        if (maxInFlight <= 0 || maxInFlight > (1 << 29)) {
+            throw new IllegalArgumentException("maxInFlight out of range: " + maxInFlight);
+        }
+        final int capacity = Integer.highestOneBit(maxInFlight * 2 - 1) << 1;
+        this.keys = new long[capacity];
+        this.sentTimes = new long[capacity];
+        this.flushTimes = new long[capacity];
+        this.prices = new long[capacity];
+        this.generations = new int[capacity];
+        this.mask = capacity - 1;
+        this.maxSize = maxInFlight;
+    }
+
+    @Override
+    public boolean put(long clientOrderId, long sentTime, long price) {
+        int index = indexFor(clientOrderId);
+        while (generations[index] == generation) {
+            if (keys[index] == clientOrderId) {
+                sentTimes[index] = sentTime;
+                flushTimes[index] = 0;
+                prices[index] = price;
+                return true;
+            }
+            index = (index + 1) & mask;
+        }
+        if (size == maxSize) {
+            return false;
+        }
+        keys[index] = clientOrderId;
+        sentTimes[index] = sentTime;
+        flushTimes[index] = 0;
+        prices[index] = price;
+        generations[index] = generation;
+        size++;
+        return true;
+    }
+
+    @Override
+    public long remove(long clientOrderId) {
+        int index = indexFor(clientOrderId);
+        while (generations[index] == generation) {
+            if (keys[index] == clientOrderId) {
+                final long sentTime = sentTimes[index];
+                lastRemovedFlushTime = flushTimes[index];
+                lastRemovedPrice = prices[index];
+                shiftBack(index);
+                size--;
+                return sentTime;
+            }
+            index = (index + 1) & mask;
+        }
+        lastRemovedPrice = MISSING;
+        return MISSING;
+    }
+
+    @Override
+    public boolean contains(long clientOrderId) {
+        int index = indexFor(clientOrderId);
+        while (generations[index] == generation) {
+            if (keys[index] == clientOrderId) {
+                return true;
+            }
+            index = (index + 1) & mask;
+        }
+        return false;
+    }
+
+    @Override
+    public boolean markFlushed(long clientOrderId, long flushTime) {
+        int index = indexFor(clientOrderId);
+        while (generations[index] == generation) {
+            if (keys[index] == clientOrderId) {
+                flushTimes[index] = flushTime;
+                return true;
+            }
+            index = (index + 1) & mask;
+        }
+        return false;
+    }
+
+    @Override
+    public long lastRemovedFlushTime() {
+        return lastRemovedFlushTime;
+    }
+
+    @Override
+    public long lastRemovedPrice() {
+        return lastRemovedPrice;
+    }
+
+    @Override
+    public int size() {
+        return size;
+    }
+
+    @Override
+    public void clear() {
+        if (++generation == 0) {
+            Arrays.fill(generations, 0);
+            generation = 1;
+        }
+        size = 0;
+    }
+
+    /**
+     * Closes the hole left at {@code hole} by moving back every following entry of the cluster whose home slot is not
+     * between the hole and its current position.
+     */
+    private void shiftBack(int hole) {
+        int index = hole;
+        while (true) {
+            index = (index + 1) & mask;
+            if (generations[index] != generation) {
+                break;
+            }
+            final int home = indexFor(keys[index]);
+            final boolean reachable = hole <= index
+                    ? hole < home && home <= index
+                    : hole < home || home <= index;
+            if (!reachable) {
+                keys[hole] = keys[index];
+                sentTimes[hole] = sentTimes[index];
+                flushTimes[hole] = flushTimes[index];
+                prices[hole] = prices[index];
+                hole = index;
+            }
+        }
+        generations[hole] = generation - 1;
+    }
+
+    private int indexFor(long key) {
+        final long hash = key * 0x9E3779B97F4A7C15L;
+        return (int) (hash ^ (hash >>> 32)) & mask;
+    }
+}
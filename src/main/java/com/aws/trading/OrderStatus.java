@@ -0,0 +1,52 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Why an order is DONE, resolved from the raw "status" bytes or the binary status code without creating a String.
+ */
+public enum OrderStatus {
+    CANCELLED,
+    FILLED,
+    /**
+     * The order was invalid, or the cancel found no order to take out of the book.
+     */
+    REJECTED,
+    UNKNOWN;
+
+    private static final OrderStatus[] KNOWN = {CANCELLED, FILLED, REJECTED};
+    private final byte[] wireName = name().getBytes(StandardCharsets.US_ASCII);
+
+    public static OrderStatus of(AsciiView status) {
+        for (OrderStatus orderStatus : KNOWN) {
+            if (status.contentEquals(orderStatus.wireName)) {
+                return orderStatus;
+            }
+        }
+        return UNKNOWN;
+    }
+
+    /**
+     * @param code a {@link BinarySchema} STATUS_ code
+     */
+    public static OrderStatus of(int code) {
+        return code >= 0 && code < KNOWN.length ? KNOWN[code] : UNKNOWN;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Order types the protocols can encode, as the JSON {@code type} and {@code time_in_force} fields and their
+ * {@link BinarySchema} bytes.
+ */
+public enum OrderType {
+    /**
+     * Good till cancelled limit order, booked for what doesn't trade right away.
+     */
+    LIMIT("LIMIT", "GOOD_TILL_CANCELLED", BinarySchema.ORDER_TYPE_LIMIT, BinarySchema.TIME_IN_FORCE_GOOD_TILL_CANCELLED),
+    /**
+     * Limit order that trades what it can when it comes in and is cancelled for the rest.
+     */
+    IOC("LIMIT", "IMMEDIATE_OR_CANCELLED", BinarySchema.ORDER_TYPE_LIMIT, BinarySchema.TIME_IN_FORCE_IMMEDIATE_OR_CANCELLED),
+    /**
+     * Trades against the other side at any price and is cancelled for the rest; its price is ignored.
+     */
+    MARKET("MARKET", "IMMEDIATE_OR_CANCELLED", BinarySchema.ORDER_TYPE_MARKET, BinarySchema.TIME_IN_FORCE_IMMEDIATE_OR_CANCELLED);
+
+    final String wireType;
+    final String wireTimeInForce;
+    final byte[] wireTypeBytes;
+    final byte[] wireTimeInForceBytes;
+    final byte binaryType;
+    final byte binaryTimeInForce;
+
+    OrderType(String wireType, String wireTimeInForce, byte binaryType, byte binaryTimeInForce) {
+        this.wireType = wireType;
+        this.wireTimeInForce = wireTimeInForce;
+        this.wireTypeBytes = wireType.getBytes(StandardCharsets.US_ASCII);
+        this.wireTimeInForceBytes = wireTimeInForce.getBytes(StandardCharsets.US_ASCII);
+        this.binaryType = binaryType;
+        this.binaryTimeInForce = binaryTimeInForce;
+    }
+
+    /**
+     * Whether what's left of the order is booked, so that it has to be cancelled.
+     */
+    boolean rests() {
+        return this == LIMIT;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.channel.ChannelHandlerContext;
+import io.netty.channel.ChannelInboundHandlerAdapter;
+import io.netty.handler.codec.http.websocketx.WebSocketFrame;
+
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Carries the time a response's bytes were first read in the pipeline over to the latency test handler, which may run
+ * on a different event loop. {@link ReadStamper} sits at the head of the pipeline and notes when each read arrives,
+ * {@link FrameStamper} sits after the WebSocket decoder and queues that time for every frame decoded from the read,
+ * and the handler polls one timestamp per frame it receives. The queue is single producer, single consumer.
+ */
+public final class ReceiveTimestamps {
+    public static final long EMPTY = Long.MIN_VALUE;
+    private static final int CAPACITY = 4096;
+    private static final int MASK = CAPACITY - 1;
+
+    private final long[] timestamps = new long[CAPACITY];
+    private final long[] frameNumbers = new long[CAPACITY];
+    private final AtomicLong producerIndex = new AtomicLong();
+    private final AtomicLong consumerIndex = new AtomicLong();
+    private long currentReadTime = EMPTY;
+    private long producedFrames;
+    private long consumedFrames;
+
+    /**
+     * Must be called once for every WebSocket frame the handler receives.
+     *
+     * @return the first read time of the frame, or {@link #EMPTY} if it was not recorded
+     */
+    public long poll() {
+        final long frameNumber = ++consumedFrames;
+        final long index = consumerIndex.get();
+        if (index == producerIndex.get()) {
+            return EMPTY;
+        }
+        final int slot = (int) index & MASK;
+        if (frameNumbers[slot] != frameNumber) {
+            // this frame's timestamp was dropped while the queue was full, the head belongs to a later frame
+            return EMPTY;
+        }
+        final long timestamp = timestamps[slot];
+        consumerIndex.lazySet(index + 1);
+        return timestamp;
+    }
+
+    private void offer(long timestamp) {
+        final long frameNumber = ++producedFrames;
+        final long index = producerIndex.get();
+        if (index - consumerIndex.get() == CAPACITY) {
+            return;
+        }
+        final int slot = (int) index & MASK;
+        timestamps[slot] = timestamp;
+        frameNumbers[slot] = frameNumber;
+        producerIndex.lazySet(index + 1);
+    }
+
+    public ReadStamper readStamper() {
+        return new ReadStamper(this);
+    }
+
+    public FrameStamper frameStamper() {
+        return new FrameStamper(this);
+    }
+
+    public static final class ReadStamper extends ChannelInboundHandlerAdapter {
+        private final ReceiveTimestamps timestamps;
+
+        private ReadStamper(ReceiveTimestamps timestamps) {
+            this.timestamps = timestamps;
+        }
+
+        @Override
+        public void channelRead(ChannelHandlerContext ctx, Object msg) throws Exception {
+            timestamps.currentReadTime = System.nanoTime();
+            ctx.fireChannelRead(msg);
+        }
+    }
+
+    public static final class FrameStamper extends ChannelInboundHandlerAdapter {
+        private final ReceiveTimestamps timestamps;
+
+        private FrameStamper(ReceiveTimestamps timestamps) {
+            this.timestamps = timestamps;
+        }
+
+        @Override
+        public void channelRead(ChannelHandlerContext ctx, Object msg) throws Exception {
+            if (msg instanceof WebSocketFrame || msg instanceof ByteBuf) {
+                timestamps.offer(timestamps.currentReadTime);
+            }
+            ctx.fireChannelRead(msg);
+        }
+    }
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.Unpooled;
+import org.apache.logging.log4j.LogManager;
+import org.apache.logging.log4j.Logger;
+
+import java.io.BufferedOutputStream;
+import java.io.BufferedReader;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.TimeUnit;
+
+import static com.aws.trading.Main.printHelpMessage;
+
+/**
+ * Recorded order flow for {@link LoadMode#REPLAY}, memory-mapped so replaying it neither parses nor allocates. The
+ * file is little endian: a header with the instrument codes the records refer to, then one fixed size record per
+ * order intent, each with its gap to the previous one.
+ *
+ * <pre>
+ * header  magic u32 "RPLY" | version u16 | instrument_count u16 | instrument [16] * instrument_count
+ * record  gap_nanos i64 | price i64 | amount i64 | instrument u16 | side u8 | type u8 | time_in_force u8 | pad [3]
+ * </pre>
+ *
+ * Side, type and time in force take the values of {@link BinarySchema}, so a zero time in force is good till cancelled. Records are dealt out to the connections round robin and
+ * every connection sends its records on one timeline shared by all of them, so the file's bursts reach the venue as
+ * they were recorded whichever connections carry them. The timeline starts shortly after the last connection has
+ * subscribed, so no connection joins it late and sends a burst of overdue records.
+ */
+public final class ReplayFile {
+    private static final Logger LOGGER = LogManager.getLogger(ReplayFile.class);
+    static final int MAGIC = 'R' | 'P' << 8 | 'L' << 16 | 'Y' << 24;
+    static final int VERSION = 1;
+    static final int HEADER_LENGTH = 8;
+    static final int RECORD_LENGTH = 32;
+    private static final int GAP = 0;
+    private static final int PRICE = 8;
+    private static final int AMOUNT = 16;
+    private static final int INSTRUMENT = 24;
+    private static final int SIDE = 26;
+    private static final int TYPE = 27;
+    private static final int TIME_IN_FORCE = 28;
+
+    private final ByteBuffer records;
+    private final String[] instruments;
+    private final byte[][] instrumentBytes;
+    private final int recordCount;
+    /**
+     * Time between the last connection subscribing and the first record being due, enough for every connection's
+     * event loop to hear about the start.
+     */
+    static final long START_DELAY_NANOS = TimeUnit.MILLISECONDS.toNanos(10);
+    private final List<Runnable> startListeners = new ArrayList<>();
+    private int unstartedCursors;
+    private volatile long startTime;
+
+    private ReplayFile(ByteBuffer records, String[] instruments) {
+        this.records = records;
+        this.instruments = instruments;
+        this.instrumentBytes = Arrays.stream(instruments)
+                .map(instrument -> instrument.getBytes(StandardCharsets.US_ASCII))
+                .toArray(byte[][]::new);
+        this.recordCount = records.capacity() / RECORD_LENGTH;
+    }
+
+    public static ReplayFile open(Path path) throws IOException {
+        final MappedByteBuffer file;
+        try (FileChannel channel = FileChannel.open(path, StandardOpenOption.READ)) {
+            if (channel.size() > Integer.MAX_VALUE) {
+                throw new IOException(path + " is larger than 2GB");
+            }
+            // the mapping stays valid after the channel is closed
+            file = channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+        }
+        file.order(ByteOrder.LITTLE_ENDIAN);
+        if (file.capacity() < HEADER_LENGTH || file.getInt(0) != MAGIC || file.getShort(4) != VERSION) {
+            throw new IOException(path + " is not a version " + VERSION + " replay file");
+        }
+        final String[] instruments = new String[file.getShort(6) & 0xFFFF];
+        if (file.capacity() < HEADER_LENGTH + instruments.length * BinarySchema.INSTRUMENT_LENGTH) {
+            throw new IOException(path + " is truncated");
+        }
+        int position = HEADER_LENGTH;
+        for (int i = 0; i < instruments.length; i++, position += BinarySchema.INSTRUMENT_LENGTH) {
+            final byte[] code = new byte[BinarySchema.INSTRUMENT_LENGTH];
+            int length = 0;
+            while (length < code.length && file.get(position + length) != 0) {
+                code[length] = file.get(position + length);
+                length++;
+            }
+            instruments[i] = new String(code, 0, length, StandardCharsets.US_ASCII);
+        }
+        if ((file.capacity() - position) % RECORD_LENGTH != 0) {
+            throw new IOException(path + " is truncated");
+        }
+        // fault the pages in now rather than on the event loops
+        file.load();
+        final ByteBuffer records = file.position(position).slice().order(ByteOrder.LITTLE_ENDIAN);
+        // checked once here rather than on the event loops, where a bad index would end the run halfway
+        for (int record = 0; record < records.capacity(); record += RECORD_LENGTH) {
+            final int instrument = records.getShort(record + INSTRUMENT) & 0xFFFF;
+            if (instrument >= instruments.length) {
+                throw new IOException(path + ": record " + record / RECORD_LENGTH + " refers to instrument " + instrument
+                        + " of " + instruments.length);
+            }
+        }
+        final ReplayFile replay = new ReplayFile(records, instruments);
+        LOGGER.info("replaying {} orders on {} instruments from {}", replay.recordCount, instruments.length, path);
+        return replay;
+    }
+
+    public int recordCount() {
+        return recordCount;
+    }
+
+    /**
+     * Records connection, connection + connections, ... of the file.
+     */
+    public Cursor cursor(int connection, int connections) {
+        synchronized (this) {
+            unstartedCursors++;
+        }
+        return new Cursor(connection, connections);
+    }
+
+    /**
+     * The instrument code of the file that equals the bytes, or null, so cancels find their instrument without
+     * creating a String.
+     */
+    public String instrument(AsciiView code) {
+        for (int i = 0; i < instrumentBytes.length; i++) {
+            if (code.contentEquals(instrumentBytes[i])) {
+                return instruments[i];
+            }
+        }
+        return null;
+    }
+
+    /**
+     * Starts the timeline every connection replays on once every cursor has been started, and then tells all of them.
+     */
+    private void started(long now, Runnable onStart) {
+        final List<Runnable> listeners;
+        synchronized (this) {
+            startListeners.add(onStart);
+            if (--unstartedCursors > 0) {
+                LOGGER.info("replay starts when {} more connections have subscribed", unstartedCursors);
+                return;
+            }
+            startTime = now + START_DELAY_NANOS;
+            listeners = new ArrayList<>(startListeners);
+            startListeners.clear();
+        }
+        listeners.forEach(Runnable::run);
+    }
+
+    /**
+     * One connection's share of the records. Not thread safe, each connection owns its cursor.
+     */
+    public final class Cursor {
+        private final int step;
+        private int index;
+        private long offsetNanos;
+        private long startTime;
+
+        private Cursor(int first, int step) {
+            this.step = step;
+            this.index = first;
+            for (int i = 0; i <= first && i < recordCount; i++) {
+                offsetNanos += gapNanos(i);
+            }
+        }
+
+        /**
+         * Marks the connection ready. The shared timeline starts when every connection is, and then {@code onStart}
+         * runs, on the thread of whichever connection was last.
+         */
+        public void start(long now, Runnable onStart) {
+            ReplayFile.this.started(now, onStart);
+        }
+
+        /**
+         * Whether the shared timeline has started, before which nothing is due.
+         */
+        public boolean hasStarted() {
+            if (startTime == 0) {
+                startTime = ReplayFile.this.startTime;
+            }
+            return startTime != 0;
+        }
+
+        public boolean hasNext() {
+            return index < recordCount;
+        }
+
+        /**
+         * When the current record is due, in System.nanoTime.
+         */
+        public long dueTime() {
+            return startTime + offsetNanos;
+        }
+
+        public String instrument() {
+            return instruments[records.getShort(index * RECORD_LENGTH + INSTRUMENT) & 0xFFFF];
+        }
+
+        public Side side() {
+            return records.get(index * RECORD_LENGTH + SIDE) == BinarySchema.SIDE_SELL ? Side.SELL : Side.BUY;
+        }
+
+        public OrderType type() {
+            final int record = index * RECORD_LENGTH;
+            if (records.get(record + TYPE) == BinarySchema.ORDER_TYPE_MARKET) {
+                return OrderType.MARKET;
+            }
+            return records.get(record + TIME_IN_FORCE) == BinarySchema.TIME_IN_FORCE_IMMEDIATE_OR_CANCELLED
+                    ? OrderType.IOC : OrderType.LIMIT;
+        }
+
+        public long price() {
+            return records.getLong(index * RECORD_LENGTH + PRICE);
+        }
+
+        public long amount() {
+            return records.getLong(index * RECORD_LENGTH + AMOUNT);
+        }
+
+        /**
+         * Moves to this connection's next record, adding up the gaps of the records other connections send.
+         */
+        public void advance() {
+            for (int i = 0; i < step; i++) {
+                index++;
+                if (index >= recordCount) {
+                    return;
+                }
+                offsetNanos += gapNanos(index);
+            }
+        }
+    }
+
+    private long gapNanos(int index) {
+        return records.getLong(index * RECORD_LENGTH + GAP);
+    }
+
+    public static void main(String[] args) {
+        if (args.length < 3) {
+            printHelpMessage();
+            System.exit(0);
+        }
+        try {
+            final int count = convertCsv(Path.of(args[1]), Path.of(args[2]), Config.DECIMAL_SCALES);
+            LOGGER.info("wrote {} orders to {}", count, args[2]);
+        } catch (IOException | IllegalArgumentException e) {
+            LOGGER.error("could not convert {}: {}", args[1], e.getMessage());
+            System.exit(1);
+        }
+    }
+
+    /**
+     * Converts a CSV of {@code timestamp_nanos,instrument,side,type,price,amount} lines, in time order, into a replay
+     * file. The first line is skipped if it's a header. Prices and amounts are decimals, e.g. {@code 27123.45}, stored
+     * in units of the last decimal place of the instrument's scales, and the type is one of {@link OrderType}'s, {@code LIMIT}, {@code IOC} or {@code MARKET}.
+     *
+     * @return number of orders written
+     */
+    public static int convertCsv(Path csv, Path replay, DecimalScales scales) throws IOException {
+        final Map<String, Integer> instrumentIndexes = new HashMap<>();
+        final List<String> instruments = new ArrayList<>();
+        final ByteBuffer records = ByteBuffer.allocate(RECORD_LENGTH).order(ByteOrder.LITTLE_ENDIAN);
+        final Path recordsFile = Files.createTempFile(replay.toAbsolutePath().getParent(), "replay", ".records");
+        int count = 0;
+        try {
+            try (BufferedReader reader = Files.newBufferedReader(csv, StandardCharsets.US_ASCII);
+                 OutputStream out = new BufferedOutputStream(Files.newOutputStream(recordsFile))) {
+                long previousTimestamp = Long.MIN_VALUE;
+                String line;
+                for (int lineNumber = 1; (line = reader.readLine()) != null; lineNumber++) {
+                    line = line.trim();
+                    if (line.isEmpty() || lineNumber == 1 && !Character.isDigit(line.charAt(0))) {
+                        continue;
+                    }
+                    final String[] fields = line.split(",");
+                    if (fields.length != 6) {
+                        throw new IllegalArgumentException("line " + lineNumber + " doesn't have 6 fields");
+                    }
+                    final long timestamp = Long.parseLong(fields[0].trim());
+                    if (timestamp < previousTimestamp) {
+                        throw new IllegalArgumentException("line " + lineNumber + " is earlier than the line before it");
+                    }
+                    final String instrument = fields[1].trim();
+                    if (instrument.length() > BinarySchema.INSTRUMENT_LENGTH) {
+                        throw new IllegalArgumentException("line " + lineNumber + ": instrument " + instrument
+                                + " is longer than " + BinarySchema.INSTRUMENT_LENGTH + " bytes");
+                    }
+                    final OrderType type;
+                    try {
+                        type = OrderType.valueOf(fields[3].trim().toUpperCase());
+                    } catch (IllegalArgumentException e) {
+                        throw new IllegalArgumentException("line " + lineNumber + ": type isn't LIMIT, IOC or MARKET");
+                    }
+                    final Side side = Side.valueOf(fields[2].trim().toUpperCase());
+                    final int instrumentIndex = instrumentIndexes.computeIfAbsent(instrument, code -> {
+                        instruments.add(code);
+                        return instruments.size() - 1;
+                    });
+                    // the header's instrument count is a u16
+                    if (instrumentIndex >= 0xFFFF) {
+                        throw new IllegalArgumentException("more than 65535 instruments");
+                    }
+                    records.clear();
+                    records.putLong(GAP, previousTimestamp == Long.MIN_VALUE ? 0 : timestamp - previousTimestamp)
+                            .putLong(PRICE, parseDecimal(fields[4], scales.priceScale(instrument), lineNumber, "price"))
+                            .putLong(AMOUNT, parseDecimal(fields[5], scales.amountScale(instrument), lineNumber, "amount"))
+                            .putShort(INSTRUMENT, (short) instrumentIndex)
+                            .put(SIDE, side == Side.SELL ? BinarySchema.SIDE_SELL : BinarySchema.SIDE_BUY)
+                            .put(TYPE, type.binaryType)
+                            .put(TIME_IN_FORCE, type.binaryTimeInForce);
+                    out.write(records.array());
+                    previousTimestamp = timestamp;
+                    count++;
+                }
+            }
+            // the header needs every instrument, so it's written once they're known and the records are appended
+            final ByteBuffer header = ByteBuffer.allocate(HEADER_LENGTH + instruments.size() * BinarySchema.INSTRUMENT_LENGTH)
+                    .order(ByteOrder.LITTLE_ENDIAN)
+                    .putInt(MAGIC)
+                    .putShort((short) VERSION)
+                    .putShort((short) instruments.size());
+            for (String instrument : instruments) {
+                final byte[] code = instrument.getBytes(StandardCharsets.US_ASCII);
+                header.put(code).put(new byte[BinarySchema.INSTRUMENT_LENGTH - code.length]);
+            }
+            try (OutputStream out = new BufferedOutputStream(Files.newOutputStream(replay))) {
+                out.write(header.array());
+                Files.copy(recordsFile, out);
+            }
+        } finally {
+            Files.deleteIfExists(recordsFile);
+        }
+        return count;
+    }
+
+    private static long parseDecimal(String field, int scale, int lineNumber, String name) {
+        final byte[] digits = field.trim().getBytes(StandardCharsets.US_ASCII);
+        final long value = AsciiNumbers.parseDecimal(new AsciiView().wrap(Unpooled.wrappedBuffer(digits), 0, digits.length), scale);
+        if (value == AsciiNumbers.INVALID) {
+            throw new IllegalArgumentException("line " + lineNumber + ": " + name + " " + field.trim()
+                    + " isn't a number with at most " + scale + " decimal places");
+        }
+        return value;
+    }
+}
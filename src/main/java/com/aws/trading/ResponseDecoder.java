@@ -0,0 +1,78 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+/**
+ * Decodes the venue's responses to orders and cancels. Implementations are flyweights: the views they hand out point
+ * into the decoded buffer and are only valid until that buffer is released or the next message is decoded.
+ */
+public interface ResponseDecoder {
+    /**
+     * Returned for a server timestamp the message doesn't carry.
+     */
+    long NO_TIMESTAMP = Long.MIN_VALUE;
+    /**
+     * Returned for a price the message doesn't carry or that isn't a decimal at the requested scale.
+     */
+    long NO_VALUE = Long.MIN_VALUE;
+
+    /**
+     * Decodes the readable bytes of the buffer without moving its reader index.
+     *
+     * @return false if the bytes are not a message of this protocol
+     */
+    boolean parse(ByteBuf buf);
+
+    MessageType messageType();
+
+    /**
+     * The client id exactly as it appeared in the message, to be echoed into a cancel.
+     */
+    AsciiView clientId();
+
+    AsciiView instrumentCode();
+
+    /**
+     * Why a DONE message's order is done, {@link OrderStatus#UNKNOWN} for other messages.
+     */
+    OrderStatus status();
+
+    /**
+     * @return the in-flight table key of the message's client id, or {@link InFlightOrderTable#MISSING}
+     */
+    long clientOrderId(ClientIdGenerator clientIds);
+
+    /**
+     * When the venue read the request, in nanoseconds of its own monotonic clock, or {@link #NO_TIMESTAMP}. Only
+     * comparable to {@link #serverSendNanos()} of the same message.
+     */
+    long serverReceiveNanos();
+
+    /**
+     * When the venue wrote the response, in nanoseconds of its own monotonic clock, or {@link #NO_TIMESTAMP}.
+     */
+    long serverSendNanos();
+
+    /**
+     * Price of a BOOKED or FILL message in units of its instrument's last decimal place, see {@link DecimalScales}, or
+     * {@link #NO_VALUE}.
+     */
+    long price(int scale);
+}
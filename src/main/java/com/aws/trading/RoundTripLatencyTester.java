@@ -17,27 +17,23 @@
  */
 package com.aws.trading;
 
+import io.netty.channel.EventLoop;
 import io.netty.channel.MultithreadEventLoopGroup;
-import io.netty.channel.nio.NioEventLoopGroup;
-import io.netty.incubator.channel.uring.IOUringEventLoopGroup;
+import io.netty.util.concurrent.EventExecutor;
 import net.openhft.affinity.AffinityStrategies;
 import net.openhft.affinity.AffinityThreadFactory;
-import org.HdrHistogram.Histogram;
-import org.HdrHistogram.HistogramLogWriter;
-import org.HdrHistogram.SingleWriterRecorder;
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 
 import java.io.*;
 import java.net.URI;
 import java.net.URISyntaxException;
+import java.nio.file.Path;
 import java.text.MessageFormat;
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Collection;
-import java.util.LinkedHashMap;
 import java.util.concurrent.ThreadFactory;
-import java.util.concurrent.TimeUnit;
-import java.util.concurrent.atomic.LongAdder;
 
 import static com.aws.trading.Config.*;
 import static java.util.stream.Collectors.toList;
@@ -52,24 +48,31 @@ public class RoundTripLatencyTester {
     private static final ThreadFactory NETTY_IO_THREAD_FACTORY = new AffinityThreadFactory("netty-io", AffinityStrategies.DIFFERENT_CORE);
     private static final ThreadFactory NETTY_WORKER_THREAD_FACTORY = new AffinityThreadFactory("netty-worker", AffinityStrategies.DIFFERENT_CORE);
     private final MultithreadEventLoopGroup nettyIOGroup;
-    public static final Histogram HISTOGRAM = new Histogram(Long.MAX_VALUE, 2);
-    public static final LongAdder MESSAGE_COUNTER = new LongAdder();
-    private static long testStartTime;
-    private static volatile long histogramStartTime;
+    private final LatencyAggregator aggregator = new LatencyAggregator(WARMUP_COUNT * TEST_SIZE, REPORT_SIZE);
     private final URI websocketURI;
     private final URI httpURI;
 
 
-    public RoundTripLatencyTester() throws URISyntaxException {
-        this.websocketURI = new URI(MessageFormat.format("ws://{0}:{1,number,#}", HOST, WEBSOCKET_PORT));
+    public RoundTripLatencyTester() throws URISyntaxException, IOException {
+        this.websocketURI = FRAMING == Framing.TCP
+                ? new URI(MessageFormat.format("tcp://{0}:{1,number,#}", HOST, TCP_PORT))
+                : new URI(MessageFormat.format("ws://{0}:{1,number,#}", HOST, WEBSOCKET_PORT));
         this.httpURI = new URI(MessageFormat.format("ws://{0}:{1,number,#}", HOST, HTTP_PORT));
-        this.nettyIOGroup = USE_IOURING ? new IOUringEventLoopGroup(NETTY_THREAD_COUNT, NETTY_IO_THREAD_FACTORY) : new NioEventLoopGroup(NETTY_THREAD_COUNT, NETTY_IO_THREAD_FACTORY);
-        this.workerGroup = USE_IOURING ? new IOUringEventLoopGroup(NETTY_THREAD_COUNT, NETTY_WORKER_THREAD_FACTORY) : new NioEventLoopGroup(NETTY_THREAD_COUNT, NETTY_WORKER_THREAD_FACTORY);
+        this.nettyIOGroup = newEventLoopGroup("netty-io", NETTY_IO_CPUS, NETTY_IO_THREAD_FACTORY);
+        this.workerGroup = EVENT_LOOP_LAYOUT == EventLoopLayout.SPLIT
+                ? newEventLoopGroup("netty-worker", NETTY_WORKER_CPUS, NETTY_WORKER_THREAD_FACTORY)
+                : null;
+        final EventLoop[] ioLoops = eventLoops(nettyIOGroup);
+        checkConnectionLoops(ioLoops.length);
+        final ReplayFile replayFile = LOAD_MODE == LoadMode.REPLAY ? ReplayFile.open(Path.of(REPLAY_FILE)) : null;
+        final Scenario scenario = SCENARIO_FILE.isEmpty() ? null : Scenario.load(Path.of(SCENARIO_FILE), COIN_PAIRS);
         var apiToken1 = API_TOKEN;
         for (int i = 0; i < exchangeClients.length; i++) {
             LOGGER.info("Creating exchang client with api token {}", apiToken1);
-            var handler = new ExchangeClientLatencyTestHandler(new ExchangeProtocolImpl(), websocketURI, apiToken1, TEST_SIZE / exchangeClients.length);
-            var exchangeClient = new ExchangeClient(apiToken1, handler, nettyIOGroup, workerGroup);
+            var replay = replayFile != null ? replayFile.cursor(i, exchangeClients.length) : null;
+            var handler = new ExchangeClientLatencyTestHandler(ExchangeProtocol.create(PROTOCOL_ENCODING), websocketURI, apiToken1,
+                    aggregator.register(), replay, scenario);
+            var exchangeClient = new ExchangeClient(apiToken1, handler, connectionLoop(ioLoops, i), workerGroup);
             this.exchangeClients[i] = exchangeClient;
             COIN_PAIRS.stream().map(x ->
                     Arrays.stream(x.split("_"))
@@ -82,6 +85,46 @@ public class RoundTripLatencyTester {
         }
     }
 
+    /**
+     * One event loop per CPU when the group has an explicit CPU list, NETTY_THREAD_COUNT loops on different cores
+     * otherwise.
+     */
+    private static MultithreadEventLoopGroup newEventLoopGroup(String name, int[] cpus, ThreadFactory defaultThreadFactory) {
+        return cpus.length > 0
+                ? TRANSPORT.newEventLoopGroup(cpus.length, new CpuListThreadFactory(name, cpus))
+                : TRANSPORT.newEventLoopGroup(NETTY_THREAD_COUNT, defaultThreadFactory);
+    }
+
+    private static EventLoop[] eventLoops(MultithreadEventLoopGroup group) {
+        final var loops = new ArrayList<EventLoop>();
+        for (EventExecutor executor : group) {
+            loops.add((EventLoop) executor);
+        }
+        return loops.toArray(new EventLoop[0]);
+    }
+
+    /**
+     * CONNECTION_LOOPS pins connections to loops and so to cores, a loop that doesn't exist is a mistake rather than
+     * something to wrap around.
+     */
+    private static void checkConnectionLoops(int loops) {
+        for (int loop : CONNECTION_LOOPS) {
+            if (loop < 0 || loop >= loops) {
+                throw new IllegalArgumentException("CONNECTION_LOOPS has loop " + loop + " but there are only " + loops
+                        + " netty-io loops, numbered from 0");
+            }
+        }
+    }
+
+    /**
+     * The loop a connection is registered with: CONNECTION_LOOPS[connection] when the map is set, round robin
+     * otherwise. Connections beyond the end of the map wrap around it.
+     */
+    private static EventLoop connectionLoop(EventLoop[] loops, int connection) {
+        final int loop = CONNECTION_LOOPS.length > 0 ? CONNECTION_LOOPS[connection % CONNECTION_LOOPS.length] : connection;
+        return CONNECTION_LOOPS.length > 0 ? loops[loop] : loops[loop % loops.length];
+    }
+
     // 1) cancel orders on ack
     // 2) package send/listen/cancel into threads (thread affiniti optional)
     // 3) capture order-to-ack timestamp difference and write to log (logj4 or chronicle log is ok )
@@ -90,8 +133,7 @@ public class RoundTripLatencyTester {
         for (ExchangeClient exchangeClient : exchangeClients) {
             exchangeClient.connect();
         }
-        testStartTime = System.nanoTime();
-        histogramStartTime = testStartTime;
+        aggregator.start();
     }
 
     public void stop() throws InterruptedException {
@@ -100,56 +142,11 @@ public class RoundTripLatencyTester {
             exchangeClient.disconnect();
         }
         this.nettyIOGroup.shutdownGracefully().await();
-        LOGGER.info("shutting down netty worker group");
-        this.workerGroup.shutdownGracefully().await();
-    }
-
-    public static synchronized void printResults(SingleWriterRecorder hdr, long orderResponseCount) {
-        long currentTime = System.nanoTime();
-        var executionTime = currentTime - testStartTime;
-        MESSAGE_COUNTER.add(orderResponseCount);
-
-        var messageCount = MESSAGE_COUNTER.longValue();
-        if (messageCount < WARMUP_COUNT * TEST_SIZE) {
-            LOGGER.info("warming up... - message count: {}", messageCount);
-            return;
-        }
-
-        HISTOGRAM.add(hdr.getIntervalHistogram());
-        if (messageCount % REPORT_SIZE == 0) {
-            var executionTimeStr = LatencyTools.formatNanos(executionTime);
-            var messagePerSecond = messageCount / TimeUnit.SECONDS.convert(executionTime, TimeUnit.NANOSECONDS);
-            var logMsg = "\nTest Execution Time: {}s \n Number of messages: {} \n Message Per Second: {} \n Percentiles: {} \n";
-
-            try (PrintStream histogramLogFile = getLogFile()) {
-                saveHistogramToFile(currentTime, histogramLogFile);
-                histogramStartTime = currentTime;
-            } catch (IOException e) {
-                LOGGER.error(e);
-            }
-
-            LinkedHashMap<String, String> latencyReport = LatencyTools.createLatencyReport(HISTOGRAM);
-            LOGGER.info(logMsg,
-                    executionTimeStr, messageCount, messagePerSecond, LatencyTools.toJSON(latencyReport)
-            );
-
-            hdr.reset();
-            HISTOGRAM.reset();
+        if (this.workerGroup != null) {
+            LOGGER.info("shutting down netty worker group");
+            this.workerGroup.shutdownGracefully().await();
         }
-    }
-
-    private static void saveHistogramToFile(long currentTime, PrintStream log) {
-        var histogramLogWriter = new HistogramLogWriter(log);
-        histogramLogWriter.outputComment("[Logged with " + "Exchange Client 0.0.1" + "]");
-        histogramLogWriter.outputLogFormatVersion();
-        histogramLogWriter.outputStartTime(TimeUnit.MILLISECONDS.convert(currentTime, TimeUnit.NANOSECONDS));
-        histogramLogWriter.setBaseTime(TimeUnit.MILLISECONDS.convert(histogramStartTime, TimeUnit.NANOSECONDS));
-        histogramLogWriter.outputLegend();
-        histogramLogWriter.outputIntervalHistogram(HISTOGRAM);
-    }
-
-    private static PrintStream getLogFile() throws IOException {
-        return new PrintStream(new FileOutputStream("./histogram.hlog", true), false);
+        aggregator.stop();
     }
 
     public static void main(String[] args) throws InterruptedException, IOException, URISyntaxException {
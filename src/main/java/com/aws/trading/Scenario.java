@@ -0,0 +1,343 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import org.apache.logging.log4j.LogManager;
+import org.apache.logging.log4j.Logger;
+
+import java.io.IOException;
+import java.io.Reader;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Properties;
+import java.util.SplittableRandom;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Order flow mix read from SCENARIO_FILE, replacing the benchmark's single buy-then-cancel pattern. A scenario is a
+ * weighted list of flows; every order the load mode sends starts one, picked by weight:
+ *
+ * <pre>
+ * flows=passive,taker
+ * flow.passive.weight=80
+ * flow.passive.type=LIMIT              # LIMIT, IOC or MARKET
+ * flow.passive.side=BUY
+ * flow.passive.instrument=BTC_USDT     # optional, one of COINPAIRS at random otherwise
+ * flow.passive.price=1-5               # drawn evenly from the range for every flow
+ * flow.passive.amount=1-10
+ * flow.passive.replaces=3              # cancel and send again this many times
+ * flow.passive.price_step=1            # added to the price on every replace
+ * flow.passive.think=100us-1ms         # pause before every replace, and before the next flow in CLOSED_LOOP
+ * flow.taker.weight=20
+ * flow.taker.type=IOC
+ * flow.taker.side=SELL
+ * </pre>
+ *
+ * A resting order is cancelled once it is BOOKED, as without a scenario. When its cancel comes back CANCELLED and the
+ * flow has replaces left, a new order goes out at the stepped price, so a chain of cancel/replace round trips runs on
+ * one flow. IOC and market orders end their flow with their own DONE. The file is compiled once into arrays, and each
+ * connection runs its flows on a {@link Session} that doesn't allocate per order.
+ */
+public final class Scenario {
+    private static final Logger LOGGER = LogManager.getLogger(Scenario.class);
+    static final int NO_SLOT = -1;
+
+    private final String[] names;
+    private final long[] cumulativeWeights;
+    private final OrderType[] types;
+    private final Side[] sides;
+    private final String[] instruments;
+    private final long[] minPrices;
+    private final long[] maxPrices;
+    private final long[] minAmounts;
+    private final long[] maxAmounts;
+    private final int[] replaces;
+    private final long[] priceSteps;
+    private final long[] minThinkNanos;
+    private final long[] maxThinkNanos;
+    private final String[] pairs;
+    private final byte[][] instrumentBytes;
+    private final String[] instrumentNames;
+
+    private Scenario(Properties properties, List<String> pairs) {
+        this.names = Arrays.stream(required(properties, "flows").split(","))
+                .map(String::trim)
+                .filter(name -> !name.isEmpty())
+                .toArray(String[]::new);
+        if (names.length == 0) {
+            throw new IllegalArgumentException("scenario has no flows");
+        }
+        final int n = names.length;
+        cumulativeWeights = new long[n];
+        types = new OrderType[n];
+        sides = new Side[n];
+        instruments = new String[n];
+        minPrices = new long[n];
+        maxPrices = new long[n];
+        minAmounts = new long[n];
+        maxAmounts = new long[n];
+        replaces = new int[n];
+        priceSteps = new long[n];
+        minThinkNanos = new long[n];
+        maxThinkNanos = new long[n];
+        long totalWeight = 0;
+        for (int i = 0; i < n; i++) {
+            final String prefix = "flow." + names[i] + ".";
+            final long weight = Long.parseLong(properties.getProperty(prefix + "weight", "1").trim());
+            if (weight <= 0) {
+                throw new IllegalArgumentException(prefix + "weight must be positive");
+            }
+            totalWeight += weight;
+            cumulativeWeights[i] = totalWeight;
+            types[i] = OrderType.valueOf(properties.getProperty(prefix + "type", "LIMIT").trim().toUpperCase());
+            sides[i] = Side.valueOf(properties.getProperty(prefix + "side", "BUY").trim().toUpperCase());
+            final String instrument = properties.getProperty(prefix + "instrument", "").trim();
+            instruments[i] = instrument.isEmpty() ? null : instrument;
+            final long[] price = range(prefix + "price", properties.getProperty(prefix + "price",
+                    Long.toString(TemplateExchangeProtocol.DEFAULT_PRICE)), false);
+            minPrices[i] = price[0];
+            maxPrices[i] = price[1];
+            if (minPrices[i] <= 0 && types[i] != OrderType.MARKET) {
+                throw new IllegalArgumentException(prefix + "price must be positive for " + types[i] + " orders");
+            }
+            final long[] amount = range(prefix + "amount", properties.getProperty(prefix + "amount",
+                    Long.toString(TemplateExchangeProtocol.DEFAULT_AMOUNT)), false);
+            minAmounts[i] = amount[0];
+            maxAmounts[i] = amount[1];
+            if (minAmounts[i] <= 0) {
+                throw new IllegalArgumentException(prefix + "amount must be positive");
+            }
+            replaces[i] = Integer.parseInt(properties.getProperty(prefix + "replaces", "0").trim());
+            if (replaces[i] < 0 || (replaces[i] > 0 && !types[i].rests())) {
+                throw new IllegalArgumentException(prefix + "replaces needs a LIMIT flow and can't be negative");
+            }
+            priceSteps[i] = Long.parseLong(properties.getProperty(prefix + "price_step", "0").trim());
+            final long[] think = range(prefix + "think", properties.getProperty(prefix + "think", "0"), true);
+            minThinkNanos[i] = think[0];
+            maxThinkNanos[i] = think[1];
+        }
+        this.pairs = pairs.toArray(new String[0]);
+        this.instrumentNames = Arrays.stream(instruments).filter(instrument -> instrument != null).distinct().toArray(String[]::new);
+        this.instrumentBytes = Arrays.stream(instrumentNames)
+                .map(instrument -> instrument.getBytes(StandardCharsets.US_ASCII))
+                .toArray(byte[][]::new);
+    }
+
+    public static Scenario load(Path path, List<String> pairs) throws IOException {
+        final Properties properties = new Properties();
+        try (Reader reader = Files.newBufferedReader(path, StandardCharsets.UTF_8)) {
+            properties.load(reader);
+        }
+        final Scenario scenario = new Scenario(properties, pairs);
+        LOGGER.info("running scenario {} with flows {}", path, String.join(", ", scenario.names));
+        return scenario;
+    }
+
+    private static String required(Properties properties, String key) {
+        final String value = properties.getProperty(key);
+        if (value == null) {
+            throw new IllegalArgumentException("scenario needs " + key);
+        }
+        return value;
+    }
+
+    /**
+     * Parses "a" or "a-b" into its bounds, numbers or, for durations, numbers followed by ns, us, ms or s.
+     */
+    private static long[] range(String key, String value, boolean duration) {
+        final String trimmed = value.trim();
+        final int dash = trimmed.indexOf('-', 1);
+        final String low = dash < 0 ? trimmed : trimmed.substring(0, dash);
+        final String high = dash < 0 ? trimmed : trimmed.substring(dash + 1);
+        try {
+            final long[] bounds = duration
+                    ? new long[]{parseNanos(low.trim()), parseNanos(high.trim())}
+                    : new long[]{Long.parseLong(low.trim()), Long.parseLong(high.trim())};
+            if (bounds[0] > bounds[1] || bounds[0] < 0) {
+                throw new IllegalArgumentException(key + " range " + value + " is empty or negative");
+            }
+            return bounds;
+        } catch (NumberFormatException e) {
+            throw new IllegalArgumentException("invalid " + key + " " + value, e);
+        }
+    }
+
+    private static long parseNanos(String duration) {
+        final TimeUnit unit;
+        final String digits;
+        if (duration.endsWith("ns")) {
+            unit = TimeUnit.NANOSECONDS;
+            digits = duration.substring(0, duration.length() - 2);
+        } else if (duration.endsWith("us")) {
+            unit = TimeUnit.MICROSECONDS;
+            digits = duration.substring(0, duration.length() - 2);
+        } else if (duration.endsWith("ms")) {
+            unit = TimeUnit.MILLISECONDS;
+            digits = duration.substring(0, duration.length() - 2);
+        } else if (duration.endsWith("s")) {
+            unit = TimeUnit.SECONDS;
+            digits = duration.substring(0, duration.length() - 1);
+        } else {
+            unit = TimeUnit.NANOSECONDS;
+            digits = duration;
+        }
+        return unit.toNanos(Long.parseLong(digits.trim()));
+    }
+
+    /**
+     * Maps the instrument code of a response back to an instrument of the scenario, null if it isn't one.
+     */
+    String instrument(AsciiView instrumentCode) {
+        for (int i = 0; i < instrumentBytes.length; i++) {
+            if (instrumentCode.contentEquals(instrumentBytes[i])) {
+                return instrumentNames[i];
+            }
+        }
+        return null;
+    }
+
+    /**
+     * @param maxFlows flows that can be running at once, the connection's in-flight table capacity
+     */
+    Session newSession(int maxFlows) {
+        return new Session(maxFlows);
+    }
+
+    /**
+     * The flows running on one connection, each in a slot that holds its order's parameters while it waits for
+     * responses or thinks. Used from the connection's event loop only.
+     */
+    final class Session {
+        private final SplittableRandom random = new SplittableRandom();
+        private final int[] flows;
+        private final String[] slotInstruments;
+        private final long[] prices;
+        private final long[] amounts;
+        private final int[] replacesLeft;
+        private final int[] freeSlots;
+        private int freeCount;
+        // client order id to slot, for as long as the flow's current order or its cancel is in flight
+        private final OpenAddressingInFlightTable slotsById;
+
+        private Session(int maxFlows) {
+            flows = new int[maxFlows];
+            slotInstruments = new String[maxFlows];
+            prices = new long[maxFlows];
+            amounts = new long[maxFlows];
+            replacesLeft = new int[maxFlows];
+            freeSlots = new int[maxFlows];
+            for (int slot = 0; slot < maxFlows; slot++) {
+                freeSlots[slot] = maxFlows - 1 - slot;
+            }
+            freeCount = maxFlows;
+            slotsById = new OpenAddressingInFlightTable(maxFlows);
+        }
+
+        boolean hasFreeSlot() {
+            return freeCount > 0;
+        }
+
+        /**
+         * Picks a flow by weight and draws its first order.
+         *
+         * @return the flow's slot, {@link #NO_SLOT} if all are taken
+         */
+        int start() {
+            if (freeCount == 0) {
+                return NO_SLOT;
+            }
+            final int slot = freeSlots[--freeCount];
+            final long pick = random.nextLong(cumulativeWeights[cumulativeWeights.length - 1]);
+            int flow = 0;
+            while (cumulativeWeights[flow] <= pick) {
+                flow++;
+            }
+            flows[slot] = flow;
+            slotInstruments[slot] = instruments[flow] != null ? instruments[flow] : pairs[random.nextInt(pairs.length)];
+            prices[slot] = draw(minPrices[flow], maxPrices[flow]);
+            amounts[slot] = draw(minAmounts[flow], maxAmounts[flow]);
+            replacesLeft[slot] = replaces[flow];
+            return slot;
+        }
+
+        /**
+         * Remembers which slot the order sent with this client order id belongs to.
+         */
+        void sent(int slot, long clientOrderId) {
+            slotsById.put(clientOrderId, slot);
+        }
+
+        /**
+         * @return the slot of the flow whose order or cancel a DONE ended, {@link #NO_SLOT} if it isn't one of ours
+         */
+        int completed(long clientOrderId) {
+            final long slot = slotsById.remove(clientOrderId);
+            return slot == InFlightOrderTable.MISSING ? NO_SLOT : (int) slot;
+        }
+
+        /**
+         * Moves the flow to its next replace, stepping the price.
+         *
+         * @return false when the flow has no replaces left
+         */
+        boolean replace(int slot) {
+            if (replacesLeft[slot] == 0) {
+                return false;
+            }
+            replacesLeft[slot]--;
+            prices[slot] = Math.max(1, prices[slot] + priceSteps[flows[slot]]);
+            return true;
+        }
+
+        void finish(int slot) {
+            freeSlots[freeCount++] = slot;
+        }
+
+        long thinkNanos(int slot) {
+            final int flow = flows[slot];
+            return draw(minThinkNanos[flow], maxThinkNanos[flow]);
+        }
+
+        OrderType type(int slot) {
+            return types[flows[slot]];
+        }
+
+        Side side(int slot) {
+            return sides[flows[slot]];
+        }
+
+        String instrument(int slot) {
+            return slotInstruments[slot];
+        }
+
+        long price(int slot) {
+            return prices[slot];
+        }
+
+        long amount(int slot) {
+            return amounts[slot];
+        }
+
+        private long draw(long min, long max) {
+            return min == max ? min : random.nextLong(min, max + 1);
+        }
+    }
+}
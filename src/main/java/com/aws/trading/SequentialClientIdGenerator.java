@@ -0,0 +1,61 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+/**
+ * Ids are {@code prefix * 10^12 + counter} in decimal, so the id text is the prefix digits followed by a zero padded
+ * 12 digit counter and parses straight back to its key.
+ */
+public final class SequentialClientIdGenerator implements ClientIdGenerator {
+    static final long COUNTER_RANGE = 1_000_000_000_000L;
+    private final long base;
+    private long counter;
+
+    public SequentialClientIdGenerator(int connectionPrefix) {
+        if (connectionPrefix < 0 || connectionPrefix >= Long.MAX_VALUE / COUNTER_RANGE) {
+            throw new IllegalArgumentException("connection prefix out of range: " + connectionPrefix);
+        }
+        this.base = connectionPrefix * COUNTER_RANGE;
+    }
+
+    @Override
+    public long next() {
+        if (++counter == COUNTER_RANGE) {
+            counter = 1;
+        }
+        return base + counter;
+    }
+
+    @Override
+    public int length(long clientOrderId) {
+        return AsciiNumbers.digitCount(clientOrderId);
+    }
+
+    @Override
+    public void write(ByteBuf out, long clientOrderId) {
+        AsciiNumbers.writeLong(out, clientOrderId);
+    }
+
+    @Override
+    public long parse(AsciiView clientId) {
+        final long key = AsciiNumbers.parseLong(clientId);
+        return key == AsciiNumbers.INVALID ? InFlightOrderTable.MISSING : key;
+    }
+}
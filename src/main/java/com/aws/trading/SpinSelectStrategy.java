@@ -0,0 +1,65 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.channel.SelectStrategy;
+import io.netty.channel.SelectStrategyFactory;
+import io.netty.util.IntSupplier;
+
+import java.util.concurrent.locks.LockSupport;
+
+/**
+ * Keeps an NIO or epoll event loop out of blocking selects. Every iteration polls the selector without waiting; when
+ * there is nothing to do the loop backs off by spinning for SPIN_ITERATIONS idle iterations, then yielding for
+ * YIELD_ITERATIONS and finally parking for PARK_NANOS at a time, and drops straight back to spinning on the next
+ * event or task. Idle iterations still return 0 rather than {@link SelectStrategy#CONTINUE} so the loop keeps running
+ * scheduled tasks.
+ */
+public final class SpinSelectStrategy implements SelectStrategy {
+    public static final SelectStrategyFactory FACTORY = SpinSelectStrategy::new;
+
+    private final long spinIterations;
+    private final long yieldLimit;
+    private final long parkNanos;
+    private long idleIterations;
+
+    private SpinSelectStrategy() {
+        this.spinIterations = Config.SPIN_ITERATIONS;
+        this.yieldLimit = Config.SPIN_ITERATIONS + Config.YIELD_ITERATIONS;
+        this.parkNanos = Config.PARK_NANOS;
+    }
+
+    @Override
+    public int calculateStrategy(IntSupplier selectSupplier, boolean hasTasks) throws Exception {
+        final int ready = selectSupplier.get();
+        if (ready > 0 || hasTasks) {
+            idleIterations = 0;
+            return ready;
+        }
+        if (idleIterations < spinIterations) {
+            idleIterations++;
+            Thread.onSpinWait();
+        } else if (idleIterations < yieldLimit) {
+            idleIterations++;
+            Thread.yield();
+        } else {
+            LockSupport.parkNanos(parkNanos);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.ByteBufAllocator;
+import io.netty.buffer.ByteBufUtil;
+import io.netty.buffer.PooledByteBufAllocator;
+import io.netty.handler.codec.http.websocketx.TextWebSocketFrame;
+
+import java.nio.charset.StandardCharsets;
+import java.util.Collection;
+import java.util.HashMap;
+import java.util.List;
+
+/**
+ * JSON encoder that pre-renders every message per instrument, order type and side into a pooled direct buffer. The fields that
+ * change per order are moved to the end of the object, so encoding copies the whole constant prefix with a single
+ * memcpy and then only writes the client id, price and amount digits, the latter at the instrument's
+ * {@link DecimalScales}.
+ */
+public class TemplateExchangeProtocol implements ExchangeProtocol {
+    static final long DEFAULT_PRICE = 1;
+    static final long DEFAULT_AMOUNT = 1;
+    final static byte[] ORDER_CLIENT_ID_END = "\",\"price\":\"".getBytes(StandardCharsets.UTF_8);
+    final static byte[] ORDER_PRICE_END = "\",\"amount\":\"".getBytes(StandardCharsets.UTF_8);
+    final static byte[] ORDER_AMOUNT_END = "\"}}".getBytes(StandardCharsets.UTF_8);
+    final static byte[] CANCEL_CLIENT_ID_END = "\"}".getBytes(StandardCharsets.UTF_8);
+    final static int ORDER_SUFFIX_LENGTH = ORDER_CLIENT_ID_END.length + ORDER_PRICE_END.length + ORDER_AMOUNT_END.length;
+
+    private final ByteBufAllocator allocator;
+    private final HashMap<String, Templates> templates = new HashMap<>();
+    private final DecimalScales scales;
+    private final ExchangeProtocolImpl fallback;
+
+    public TemplateExchangeProtocol() {
+        this(PooledByteBufAllocator.DEFAULT, List.of());
+    }
+
+    public TemplateExchangeProtocol(ByteBufAllocator allocator, Collection<String> pairs) {
+        this(allocator, pairs, DecimalScales.NONE);
+    }
+
+    /**
+     * @param pairs instruments rendered up front, any other pair gets its templates on first use
+     */
+    public TemplateExchangeProtocol(ByteBufAllocator allocator, Collection<String> pairs, DecimalScales scales) {
+        this.allocator = allocator;
+        this.scales = scales;
+        this.fallback = new ExchangeProtocolImpl(scales);
+        pairs.forEach(this::templatesFor);
+    }
+
+    private static final class Templates {
+        /**
+         * Indexed by {@link OrderType} and then {@link Side} ordinal.
+         */
+        final ByteBuf[][] orders;
+        final ByteBuf cancel;
+        final int priceScale;
+        final int amountScale;
+
+        Templates(ByteBuf[][] orders, ByteBuf cancel, int priceScale, int amountScale) {
+            this.orders = orders;
+            this.cancel = cancel;
+            this.priceScale = priceScale;
+            this.amountScale = amountScale;
+        }
+
+        ByteBuf order(OrderType type, Side side) {
+            return orders[type.ordinal()][side.ordinal()];
+        }
+    }
+
+    private Templates templatesFor(String pair) {
+        return templates.computeIfAbsent(pair, p -> {
+            final ByteBuf[][] orders = new ByteBuf[OrderType.values().length][Side.values().length];
+            for (OrderType type : OrderType.values()) {
+                for (Side side : Side.values()) {
+                    orders[type.ordinal()][side.ordinal()] = render("{\"type\":\"CREATE_ORDER\",\"order\":{\"instrument_code\":\"" + p
+                            + "\",\"side\":\"" + side + "\",\"type\":\"" + type.wireType
+                            + "\",\"time_in_force\":\"" + type.wireTimeInForce + "\",\"client_id\":\"");
+                }
+            }
+            return new Templates(orders, render("{\"type\":\"CANCEL_ORDER\",\"instrument_code\":\"" + p + "\",\"client_id\":\""),
+                    scales.priceScale(p), scales.amountScale(p));
+        });
+    }
+
+    private ByteBuf render(String prefix) {
+        final byte[] bytes = prefix.getBytes(StandardCharsets.UTF_8);
+        return allocator.directBuffer(bytes.length, bytes.length).writeBytes(bytes);
+    }
+
+    private ByteBuf startMessage(ByteBuf template, int variableLength) {
+        final int prefixLength = template.readableBytes();
+        final ByteBuf buf = allocator.directBuffer(prefixLength + variableLength);
+        buf.writeBytes(template, template.readerIndex(), prefixLength);
+        return buf;
+    }
+
+    public TextWebSocketFrame createOrder(String pair, OrderType type, Side side, ClientIdGenerator clientIds, long clientOrderId, long price, long amount) {
+        final Templates t = templatesFor(pair);
+        final ByteBuf buf = startMessage(t.order(type, side), clientIds.length(clientOrderId)
+                + AsciiNumbers.decimalLength(price, t.priceScale) + AsciiNumbers.decimalLength(amount, t.amountScale)
+                + ORDER_SUFFIX_LENGTH);
+        clientIds.write(buf, clientOrderId);
+        buf.writeBytes(ORDER_CLIENT_ID_END);
+        AsciiNumbers.writeDecimal(buf, price, t.priceScale);
+        buf.writeBytes(ORDER_PRICE_END);
+        AsciiNumbers.writeDecimal(buf, amount, t.amountScale);
+        buf.writeBytes(ORDER_AMOUNT_END);
+        return new TextWebSocketFrame(buf);
+    }
+
+    public TextWebSocketFrame createBuyOrder(String pair, ClientIdGenerator clientIds, long clientOrderId) {
+        return createOrder(pair, OrderType.LIMIT, Side.BUY, clientIds, clientOrderId, DEFAULT_PRICE, DEFAULT_AMOUNT);
+    }
+
+    public TextWebSocketFrame createCancelOrder(String pair, AsciiView clientId) {
+        final ByteBuf buf = startMessage(templatesFor(pair).cancel, clientId.length() + CANCEL_CLIENT_ID_END.length);
+        clientId.copyTo(buf);
+        buf.writeBytes(CANCEL_CLIENT_ID_END);
+        return new TextWebSocketFrame(buf);
+    }
+
+    public TextWebSocketFrame createBuyOrder(String pair, String clientId) {
+        return new TextWebSocketFrame(createOrderWithStringId(templatesFor(pair).order(OrderType.LIMIT, Side.BUY), clientId, ExchangeProtocolImpl.dummyBuyPrice));
+    }
+
+    public ByteBuf createSellOrder(String pair, String clientId) {
+        return createOrderWithStringId(templatesFor(pair).order(OrderType.LIMIT, Side.SELL), clientId, ExchangeProtocolImpl.dummySellPrice);
+    }
+
+    private ByteBuf createOrderWithStringId(ByteBuf template, String clientId, byte[] price) {
+        final ByteBuf buf = startMessage(template, clientId.length() + price.length
+                + ExchangeProtocolImpl.dummyAmount.length + ORDER_SUFFIX_LENGTH);
+        ByteBufUtil.writeAscii(buf, clientId);
+        buf.writeBytes(ORDER_CLIENT_ID_END).writeBytes(price)
+                .writeBytes(ORDER_PRICE_END).writeBytes(ExchangeProtocolImpl.dummyAmount)
+                .writeBytes(ORDER_AMOUNT_END);
+        return buf;
+    }
+
+    /**
+     * Arbitrary order types are not templated.
+     */
+    public ByteBuf createOrder(String pair, String type, String uuid, String side, String price, String qty) {
+        return fallback.createOrder(pair, type, uuid, side, price, qty);
+    }
+
+    public TextWebSocketFrame createCancelOrder(String pair, String clientid) {
+        final ByteBuf buf = startMessage(templatesFor(pair).cancel, clientid.length() + CANCEL_CLIENT_ID_END.length);
+        ByteBufUtil.writeAscii(buf, clientid);
+        buf.writeBytes(CANCEL_CLIENT_ID_END);
+        return new TextWebSocketFrame(buf);
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.bootstrap.Bootstrap;
+import io.netty.channel.ChannelOption;
+import io.netty.channel.MultithreadEventLoopGroup;
+import io.netty.channel.SelectStrategy;
+import io.netty.channel.epoll.EpollChannelOption;
+import io.netty.channel.epoll.EpollEventLoopGroup;
+import io.netty.channel.epoll.EpollSocketChannel;
+import io.netty.channel.nio.NioEventLoopGroup;
+import io.netty.channel.socket.nio.NioSocketChannel;
+import io.netty.channel.unix.IntegerUnixChannelOption;
+import io.netty.incubator.channel.uring.IOUringEventLoopGroup;
+import io.netty.incubator.channel.uring.IOUringSocketChannel;
+
+import java.nio.channels.spi.SelectorProvider;
+import java.util.concurrent.ThreadFactory;
+
+import static com.aws.trading.Config.BUSY_SPIN;
+import static com.aws.trading.Config.EPOLL_BUSY_WAIT;
+import static com.aws.trading.Config.EPOLL_MODE;
+import static com.aws.trading.Config.IOURING_ASYNC_THRESHOLD;
+import static com.aws.trading.Config.IOURING_RING_SIZE;
+import static com.aws.trading.Config.SO_BUSY_POLL_MICROS;
+
+/**
+ * Netty transport the event loops and channels are built on.
+ */
+public enum Transport {
+    /**
+     * JDK selector, portable.
+     */
+    NIO,
+    /**
+     * Native epoll, EPOLL_MODE defaults to edge triggered. EPOLL_BUSY_WAIT spins on epoll_wait instead of sleeping
+     * in it and SO_BUSY_POLL_MICROS lets the socket busy poll the device queue on reads.
+     */
+    EPOLL,
+    /**
+     * io_uring with IOURING_RING_SIZE entries. The incubator transport doesn't offer SQPOLL, submissions are made by
+     * the event loop thread, and it has no select strategy to hook BUSY_SPIN into.
+     */
+    IO_URING;
+
+    private static final int SOL_SOCKET = 1;
+    private static final int SO_BUSY_POLL = 46;
+    private static final ChannelOption<Integer> BUSY_POLL_OPTION =
+            new IntegerUnixChannelOption("SO_BUSY_POLL", SOL_SOCKET, SO_BUSY_POLL);
+
+    public MultithreadEventLoopGroup newEventLoopGroup(int threads, ThreadFactory threadFactory) {
+        if (BUSY_SPIN) {
+            return newSpinningEventLoopGroup(threads, threadFactory);
+        }
+        switch (this) {
+            case EPOLL:
+                return EPOLL_BUSY_WAIT
+                        ? new EpollEventLoopGroup(threads, threadFactory, () -> (selectSupplier, hasTasks) -> SelectStrategy.BUSY_WAIT)
+                        : new EpollEventLoopGroup(threads, threadFactory);
+            case IO_URING:
+                return new IOUringEventLoopGroup(threads, threadFactory, IOURING_RING_SIZE, IOURING_ASYNC_THRESHOLD);
+            default:
+                return new NioEventLoopGroup(threads, threadFactory);
+        }
+    }
+
+    private MultithreadEventLoopGroup newSpinningEventLoopGroup(int threads, ThreadFactory threadFactory) {
+        switch (this) {
+            case EPOLL:
+                return new EpollEventLoopGroup(threads, threadFactory, SpinSelectStrategy.FACTORY);
+            case NIO:
+                // every idle iteration looks like a premature selector wake-up to NIO, keep it from rebuilding the
+                // selector over them; read when the first NIO event loop class is loaded
+                System.setProperty("io.netty.selectorAutoRebuildThreshold", "0");
+                return new NioEventLoopGroup(threads, threadFactory, SelectorProvider.provider(), SpinSelectStrategy.FACTORY);
+            default:
+                throw new IllegalArgumentException("BUSY_SPIN is not supported by the " + this + " transport");
+        }
+    }
+
+    /**
+     * Sets the channel class and the transport specific socket options.
+     */
+    public Bootstrap configure(Bootstrap bootstrap) {
+        switch (this) {
+            case EPOLL:
+                bootstrap.channel(EpollSocketChannel.class)
+                        .option(EpollChannelOption.EPOLL_MODE, EPOLL_MODE);
+                if (SO_BUSY_POLL_MICROS > 0) {
+                    bootstrap.option(BUSY_POLL_OPTION, SO_BUSY_POLL_MICROS);
+                }
+                return bootstrap;
+            case IO_URING:
+                return bootstrap.channel(IOUringSocketChannel.class);
+            default:
+                return bootstrap.channel(NioSocketChannel.class);
+        }
+    }
+
+    /**
+     * The transport with the settings that apply to it, for the report.
+     */
+    public String description() {
+        if (BUSY_SPIN) {
+            return this + " (" + (this == EPOLL ? EPOLL_MODE + ", " : "") + "busy spin"
+                    + (this == EPOLL && SO_BUSY_POLL_MICROS > 0 ? ", SO_BUSY_POLL " + SO_BUSY_POLL_MICROS + "us" : "") + ")";
+        }
+        switch (this) {
+            case EPOLL:
+                return this + " (" + EPOLL_MODE
+                        + (EPOLL_BUSY_WAIT ? ", busy wait" : "")
+                        + (SO_BUSY_POLL_MICROS > 0 ? ", SO_BUSY_POLL " + SO_BUSY_POLL_MICROS + "us" : "") + ")";
+            case IO_URING:
+                return this + " (ring size " + IOURING_RING_SIZE + ")";
+            default:
+                return toString();
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.buffer.ByteBuf;
+
+import java.nio.charset.StandardCharsets;
+import java.util.UUID;
+
+/**
+ * Random UUID ids. The key is the UUID's least significant 64 bits, which are the last 16 hex digits of its text form,
+ * so only the most recent id can be written back out.
+ */
+public final class UuidClientIdGenerator implements ClientIdGenerator {
+    private static final int UUID_LENGTH = 36;
+    private static final byte[] HEX_DIGITS = "0123456789abcdef".getBytes(StandardCharsets.US_ASCII);
+    private long mostSigBits;
+    private long leastSigBits;
+
+    @Override
+    public long next() {
+        final UUID uuid = UUID.randomUUID();
+        this.mostSigBits = uuid.getMostSignificantBits();
+        this.leastSigBits = uuid.getLeastSignificantBits();
+        return leastSigBits;
+    }
+
+    @Override
+    public int length(long clientOrderId) {
+        return UUID_LENGTH;
+    }
+
+    @Override
+    public void write(ByteBuf out, long clientOrderId) {
+        if (clientOrderId != leastSigBits) {
+            throw new IllegalStateException("only the latest UUID can be written");
+        }
+        out.ensureWritable(UUID_LENGTH);
+        final int start = out.writerIndex();
+        writeHex(out, start, mostSigBits >>> 32, 8);
+        out.setByte(start + 8, '-');
+        writeHex(out, start + 9, mostSigBits >>> 16, 4);
+        out.setByte(start + 13, '-');
+        writeHex(out, start + 14, mostSigBits, 4);
+        out.setByte(start + 18, '-');
+        writeHex(out, start + 19, leastSigBits >>> 48, 4);
+        out.setByte(start + 23, '-');
+        writeHex(out, start + 24, leastSigBits, 12);
+        out.writerIndex(start + UUID_LENGTH);
+    }
+
+    @Override
+    public long parse(AsciiView clientId) {
+        final int length = clientId.length();
+        if (length != UUID_LENGTH) {
+            return InFlightOrderTable.MISSING;
+        }
+        long key = 0;
+        for (int i = length - 17; i < length; i++) {
+            final int digit = Character.digit(clientId.byteAt(i), 16);
+            if (digit >= 0) {
+                key = (key << 4) | digit;
+            } else if (i != length - 13) {
+                return InFlightOrderTable.MISSING;
+            }
+        }
+        return key;
+    }
+
+    private static void writeHex(ByteBuf out, int index, long value, int digits) {
+        for (int i = index + digits - 1; i >= index; i--) {
+            out.setByte(i, HEX_DIGITS[(int) (value & 0xF)]);
+            value >>>= 4;
+        }
+    }
+}
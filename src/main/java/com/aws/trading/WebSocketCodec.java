@@ -0,0 +1,49 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.channel.ChannelPipeline;
+
+/**
+ * Frame codec the pipeline uses once the WebSocket handshake has completed.
+ */
+public enum WebSocketCodec {
+    /**
+     * The encoder and decoder the handshaker installs.
+     */
+    NETTY,
+    /**
+     * {@link FastWebSocketFrameEncoder} and {@link FastWebSocketFrameDecoder}. Frames of the order entry protocol reach
+     * the handler as plain {@link io.netty.buffer.ByteBuf}s.
+     */
+    FAST;
+
+    /**
+     * Swaps the handshaker's codec for this one. Must be called right after the handshake finished, before any frame
+     * has been received.
+     *
+     * @param binary whether order entry uses binary frames, see {@link ExchangeProtocol#isBinary()}
+     */
+    public void install(ChannelPipeline pipeline, int maxFramePayloadLength, boolean binary) {
+        if (this == FAST) {
+            pipeline.replace("ws-decoder", "ws-decoder", new FastWebSocketFrameDecoder(maxFramePayloadLength,
+                    binary ? FastWebSocketFrameEncoder.OPCODE_BINARY : FastWebSocketFrameEncoder.OPCODE_TEXT));
+            pipeline.replace("ws-encoder", "ws-encoder", new FastWebSocketFrameEncoder());
+        }
+    }
+}
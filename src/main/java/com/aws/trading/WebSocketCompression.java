@@ -0,0 +1,186 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+package com.aws.trading;
+
+import io.netty.channel.ChannelHandler;
+import io.netty.channel.ChannelHandlerContext;
+import io.netty.channel.ChannelInboundHandlerAdapter;
+import io.netty.channel.ChannelOutboundHandlerAdapter;
+import io.netty.channel.ChannelPipeline;
+import io.netty.channel.ChannelPromise;
+import io.netty.handler.codec.http.websocketx.WebSocketFrame;
+import io.netty.handler.codec.http.websocketx.extensions.WebSocketClientExtensionHandler;
+import io.netty.handler.codec.http.websocketx.extensions.WebSocketExtension;
+import io.netty.handler.codec.http.websocketx.extensions.WebSocketExtensionFilter;
+import io.netty.handler.codec.http.websocketx.extensions.WebSocketExtensionFilterProvider;
+import io.netty.handler.codec.http.websocketx.extensions.compression.PerMessageDeflateClientExtensionHandshaker;
+import io.netty.handler.codec.http.websocketx.extensions.compression.PerMessageDeflateDecoder;
+import io.netty.handler.codec.http.websocketx.extensions.compression.PerMessageDeflateEncoder;
+import org.HdrHistogram.SingleWriterRecorder;
+
+import static com.aws.trading.Config.WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER;
+import static com.aws.trading.Config.WS_DEFLATE_LEVEL;
+import static com.aws.trading.Config.WS_DEFLATE_MIN_SIZE;
+import static com.aws.trading.Config.WS_DEFLATE_OUTBOUND;
+import static com.aws.trading.Config.WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER;
+
+/**
+ * permessage-deflate for the WebSocket connection, and the timing of it.
+ * <p>
+ * The extension handler offers permessage-deflate in the upgrade request and, if the venue accepts it, installs
+ * Netty's deflate encoder and decoder. Context takeover is configured per direction. Whether the venue compresses its
+ * messages is up to the venue; outbound frames are only compressed with WS_DEFLATE_OUTBOUND and when they are at
+ * least WS_DEFLATE_MIN_SIZE bytes, so small orders can skip the deflate cost.
+ * <p>
+ * {@link #installTimers} brackets the deflate encoder and decoder with handlers that time every frame they actually
+ * compress or decompress. Both run on the channel's event loop, which is therefore the only writer of the recorder.
+ */
+public final class WebSocketCompression {
+    private static final int DEFAULT_WINDOW_SIZE = 15;
+
+    private WebSocketCompression() {
+    }
+
+    public static WebSocketClientExtensionHandler newExtensionHandler() {
+        final WebSocketExtensionFilter encoderFilter = frame ->
+                !WS_DEFLATE_OUTBOUND || frame.content().readableBytes() < WS_DEFLATE_MIN_SIZE;
+        final WebSocketExtensionFilterProvider filters = new WebSocketExtensionFilterProvider() {
+            @Override
+            public WebSocketExtensionFilter encoderFilter() {
+                return encoderFilter;
+            }
+
+            @Override
+            public WebSocketExtensionFilter decoderFilter() {
+                return WebSocketExtensionFilter.NEVER_SKIP;
+            }
+        };
+        return new WebSocketClientExtensionHandler(new PerMessageDeflateClientExtensionHandshaker(
+                WS_DEFLATE_LEVEL, false, DEFAULT_WINDOW_SIZE,
+                WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER, WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER, filters));
+    }
+
+    /**
+     * Adds the timers around the deflate handlers, if the extension was negotiated. Must be called once the
+     * handshake response has passed the extension handler.
+     */
+    public static void installTimers(ChannelPipeline pipeline, SingleWriterRecorder recorder) {
+        final String decoder = nameOf(pipeline, PerMessageDeflateDecoder.class);
+        final String encoder = nameOf(pipeline, PerMessageDeflateEncoder.class);
+        if (decoder == null || encoder == null) {
+            return;
+        }
+        final Timer timer = new Timer(recorder);
+        pipeline.addBefore(decoder, "deflate-in-start", new InboundStart(timer));
+        pipeline.addAfter(decoder, "deflate-in-end", new InboundEnd(timer));
+        // outbound messages travel towards the head, so they reach the handler after the encoder first
+        pipeline.addAfter(encoder, "deflate-out-start", new OutboundStart(timer));
+        pipeline.addBefore(encoder, "deflate-out-end", new OutboundEnd(timer));
+    }
+
+    private static String nameOf(ChannelPipeline pipeline, Class<? extends ChannelHandler> type) {
+        final ChannelHandlerContext ctx = pipeline.context(type);
+        return ctx == null ? null : ctx.name();
+    }
+
+    private static boolean compressed(Object msg) {
+        return msg instanceof WebSocketFrame && (((WebSocketFrame) msg).rsv() & WebSocketExtension.RSV1) != 0;
+    }
+
+    /**
+     * Deflate runs synchronously inside the start handler's fire, so the end handler sees the same frame.
+     */
+    private static final class Timer {
+        private final SingleWriterRecorder recorder;
+        private long inboundStart;
+        private long outboundStart;
+
+        private Timer(SingleWriterRecorder recorder) {
+            this.recorder = recorder;
+        }
+
+        private void record(long start) {
+            final long nanos = System.nanoTime() - start;
+            if (nanos > 0) {
+                recorder.recordValue(nanos);
+            }
+        }
+    }
+
+    private static final class InboundStart extends ChannelInboundHandlerAdapter {
+        private final Timer timer;
+
+        private InboundStart(Timer timer) {
+            this.timer = timer;
+        }
+
+        @Override
+        public void channelRead(ChannelHandlerContext ctx, Object msg) throws Exception {
+            timer.inboundStart = compressed(msg) ? System.nanoTime() : 0;
+            ctx.fireChannelRead(msg);
+        }
+    }
+
+    private static final class InboundEnd extends ChannelInboundHandlerAdapter {
+        private final Timer timer;
+
+        private InboundEnd(Timer timer) {
+            this.timer = timer;
+        }
+
+        @Override
+        public void channelRead(ChannelHandlerContext ctx, Object msg) throws Exception {
+            if (timer.inboundStart != 0) {
+                timer.record(timer.inboundStart);
+                timer.inboundStart = 0;
+            }
+            ctx.fireChannelRead(msg);
+        }
+    }
+
+    private static final class OutboundStart extends ChannelOutboundHandlerAdapter {
+        private final Timer timer;
+
+        private OutboundStart(Timer timer) {
+            this.timer = timer;
+        }
+
+        @Override
+        public void write(ChannelHandlerContext ctx, Object msg, ChannelPromise promise) throws Exception {
+            timer.outboundStart = System.nanoTime();
+            ctx.write(msg, promise);
+        }
+    }
+
+    private static final class OutboundEnd extends ChannelOutboundHandlerAdapter {
+        private final Timer timer;
+
+        private OutboundEnd(Timer timer) {
+            this.timer = timer;
+        }
+
+        @Override
+        public void write(ChannelHandlerContext ctx, Object msg, ChannelPromise promise) throws Exception {
+            if (timer.outboundStart != 0 && compressed(msg)) {
+                timer.record(timer.outboundStart);
+            }
+            timer.outboundStart = 0;
+            ctx.write(msg, promise);
+        }
+    }
+}
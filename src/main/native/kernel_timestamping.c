@@ -0,0 +1,110 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * JNI side of com.aws.trading.KernelTimestamping. Build with
+ *
+ *   gcc -O2 -shared -fPIC -I"$JAVA_HOME/include" -I"$JAVA_HOME/include/linux" \
+ *       -o libkerneltimestamping.so src/main/native/kernel_timestamping.c
+ *
+ * and start the client with -Djava.library.path pointing at the directory holding the library.
+ */
+#include <jni.h>
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+#define MAX_ENTRIES 64
+
+static jlong to_nanos(const struct timespec *ts) {
+    return (jlong) ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+JNIEXPORT jint JNICALL Java_com_aws_trading_KernelTimestamping_enable0(JNIEnv *env, jclass clazz, jint fd, jint flags) {
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0) {
+        return -errno;
+    }
+    return 0;
+}
+
+/*
+ * Drains up to maxEntries timestamps from the socket error queue into out as (key, type, CLOCK_REALTIME nanos)
+ * triples. Returns the number of triples written, or -errno if the first read failed with anything but EAGAIN.
+ */
+JNIEXPORT jint JNICALL Java_com_aws_trading_KernelTimestamping_readTxTimestamps0(JNIEnv *env, jclass clazz, jint fd,
+                                                                                 jlongArray out, jint maxEntries) {
+    jlong entries[3 * MAX_ENTRIES];
+    char control[256];
+    char data[1];
+    int count = 0;
+    if (maxEntries > MAX_ENTRIES) {
+        maxEntries = MAX_ENTRIES;
+    }
+    while (count < maxEntries) {
+        struct iovec iov = {.iov_base = data, .iov_len = sizeof(data)};
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (count == 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                return -errno;
+            }
+            break;
+        }
+        const struct scm_timestamping *tss = NULL;
+        const struct sock_extended_err *serr = NULL;
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPING) {
+                tss = (const struct scm_timestamping *) CMSG_DATA(cm);
+            } else if ((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR)
+                       || (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+                serr = (const struct sock_extended_err *) CMSG_DATA(cm);
+            }
+        }
+        if (tss == NULL || serr == NULL || serr->ee_errno != ENOMSG || serr->ee_origin != SO_EE_ORIGIN_TIMESTAMPING) {
+            continue;
+        }
+        /* ts[2] carries the raw hardware stamp when the NIC provides one, ts[0] the software stamp */
+        const struct timespec *ts = (tss->ts[2].tv_sec != 0 || tss->ts[2].tv_nsec != 0) ? &tss->ts[2] : &tss->ts[0];
+        entries[3 * count] = serr->ee_data;
+        entries[3 * count + 1] = serr->ee_info;
+        entries[3 * count + 2] = to_nanos(ts);
+        count++;
+    }
+    if (count > 0) {
+        (*env)->SetLongArrayRegion(env, out, 0, 3 * count, entries);
+    }
+    return count;
+}
+
+JNIEXPORT jlong JNICALL Java_com_aws_trading_KernelTimestamping_realtimeNanos0(JNIEnv *env, jclass clazz) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return to_nanos(&ts);
+}